@@ -0,0 +1,318 @@
+#include "sources/game.hpp"
+#include "sources/physics.hpp"
+#include "sources/platform.hpp"
+#include "sources/profiler.hpp"
+#include "sources/rasterizer.hpp"
+#include "sources/record_table.hpp"
+#include "sources/render_list.hpp"
+#include "sources/settings.hpp"
+#include "sources/simulation.hpp"
+#include "sources/text.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Keeps the compiler from discarding the results of the benchmarked functions.
+ */
+static volatile U64 sink;
+
+static const U64 benchmark_seed = 1;
+
+static const char *const records_filename = "benchmark_records.txt";
+
+class BenchmarkOptions {
+public:
+  std::string filter;
+  std::string output;
+  size_t samples = 25;
+  double sample_seconds = 0.002;
+};
+
+/**
+ * The statistics of one benchmark, in nanoseconds per call.
+ */
+class Measurement {
+public:
+  std::string name;
+  std::string window;
+  U32 platforms = 0;
+  U64 iterations = 0;
+  size_t samples = 0;
+  double median = 0.0;
+  double p95 = 0.0;
+  double mean = 0.0;
+  double minimum = 0.0;
+};
+
+/**
+ * Everything a Game points to, kept together so that the pointers stay valid.
+ */
+class Fixture {
+public:
+  Settings settings;
+  CommandTable table{};
+  Player player;
+  Profiler profiler;
+  std::unique_ptr<Game> game;
+
+  Fixture(U32 width, U32 height, U32 platforms) : settings(settings_filename), player("Benchmark", &table), profiler(false) {
+    settings.set("PLATFORM_COUNT", std::to_string(platforms).c_str());
+    settings.compute_window_size(width, height);
+    initialize_command_table(&table);
+    game = std::unique_ptr<Game>(new Game(&player, &settings, &profiler, benchmark_seed));
+  }
+};
+
+class BenchmarkRunner {
+public:
+  explicit BenchmarkRunner(const BenchmarkOptions &options) : options(options) {
+  }
+
+  /**
+   * Measures the body, calling it enough times per sample for the clock resolution not to matter.
+   */
+  template <typename Body> void run(const std::string &name, const std::string &window, U32 platforms, Body body) {
+    if (name.find(options.filter) == std::string::npos) {
+      return;
+    }
+    U64 iterations = 1;
+    while (time_calls(body, iterations) < options.sample_seconds && iterations < (1ULL << 30)) {
+      iterations *= 2;
+    }
+    std::vector<double> times;
+    for (size_t i = 0; i < options.samples; i++) {
+      times.push_back(time_calls(body, iterations) * 1e9 / iterations);
+    }
+    std::sort(times.begin(), times.end());
+    Measurement measurement;
+    measurement.name = name;
+    measurement.window = window;
+    measurement.platforms = platforms;
+    measurement.iterations = iterations * options.samples;
+    measurement.samples = options.samples;
+    measurement.median = times[times.size() / 2];
+    measurement.p95 = times[std::min(times.size() - 1, times.size() * 95 / 100)];
+    measurement.minimum = times.front();
+    for (const double time : times) {
+      measurement.mean += time / times.size();
+    }
+    std::cerr << name << ' ' << window << ' ' << platforms << ": " << double_to_string(measurement.median, 1) << " ns" << '\n';
+    measurements.push_back(measurement);
+  }
+
+  void write_json(std::ostream &stream) const {
+    stream << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < measurements.size(); i++) {
+      const Measurement &m = measurements[i];
+      stream << (i == 0 ? "\n" : ",\n");
+      stream << "    {\"name\": \"" << m.name << "\", \"window\": \"" << m.window << "\", \"platforms\": " << m.platforms;
+      stream << ", \"iterations\": " << m.iterations << ", \"samples\": " << m.samples;
+      stream << ", \"median_ns\": " << double_to_string(m.median, 1) << ", \"p95_ns\": " << double_to_string(m.p95, 1);
+      stream << ", \"mean_ns\": " << double_to_string(m.mean, 1) << ", \"min_ns\": " << double_to_string(m.minimum, 1) << "}";
+    }
+    stream << "\n  ]\n}\n";
+  }
+
+private:
+  template <typename Body> static double time_calls(Body &body, U64 iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    for (U64 i = 0; i < iterations; i++) {
+      body();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  const BenchmarkOptions &options;
+  std::vector<Measurement> measurements;
+};
+
+static void run_game_benchmarks(BenchmarkRunner &runner, U32 width, U32 height, U32 platforms) {
+  const std::string window = std::to_string(width) + "x" + std::to_string(height);
+  {
+    Fixture fixture(width, height, platforms);
+    Game *game = fixture.game.get();
+    runner.run("update_platforms", window, platforms, [game]() {
+      update_platforms(game);
+      game->current_frame++;
+    });
+  }
+  {
+    Fixture fixture(width, height, platforms);
+    Game *game = fixture.game.get();
+    SimulationInput input(INPUT_MODE_RANDOM, static_cast<U32>(benchmark_seed));
+    runner.run("update_player", window, platforms, [game, &input]() {
+      input.apply(game->current_frame++, game->player->table);
+      update_player(game, game->player);
+      game->player->lives = 3;
+    });
+  }
+  {
+    Fixture fixture(width, height, platforms);
+    Game *game = fixture.game.get();
+    /* Alternate between two snapshots a few ticks apart, as a lookahead would. */
+    const GameSnapshot before = game->snapshot();
+    for (int i = 0; i < 5; i++) {
+      update_platforms(game);
+    }
+    const GameSnapshot after = game->snapshot();
+    bool restore_before = true;
+    runner.run("Game::restore", window, platforms, [game, &before, &after, &restore_before]() {
+      game->restore(restore_before ? before : after);
+      restore_before = !restore_before;
+    });
+  }
+  {
+    Fixture fixture(width, height, platforms);
+    Game *game = fixture.game.get();
+    if (!game->platforms.empty()) {
+      runner.run("reposition_platform", window, platforms, [game]() {
+        /* Take the platform out of the box, which leaves nothing in the collider for reposition to remove. */
+        Platform platform = game->platforms.get(0);
+        modify_rigid_matrix_platform(game, 0, &platform, -1);
+        platform.x = game->box.max_x + 1;
+        modify_rigid_matrix_platform(game, 0, &platform, 1);
+        reposition_platform(game, 0, &platform);
+        game->platforms.set(0, platform);
+      });
+    }
+  }
+  {
+    Fixture fixture(width, height, platforms);
+    Game *game = fixture.game.get();
+    const auto lines = static_cast<size_t>((game->box.max_y - game->box.min_y + 1) / game->tile_h);
+    std::vector<U8> occupied(lines);
+    for (const S32 y : game->platforms.y) {
+      occupied[(y - game->box.min_y) / game->tile_h] = 1;
+    }
+    runner.run("select_random_line_awarely", window, platforms, [game, &occupied]() {
+      sink = sink + select_random_line_awarely(occupied, game->generator);
+    });
+    runner.run("select_random_line_blindly", window, platforms, [game, &occupied]() {
+      sink = sink + select_random_line_blindly(occupied, game->generator);
+    });
+    runner.run("LineOccupancy::select_awarely", window, platforms, [game]() { sink = sink + game->lines.select_awarely(game->generator); });
+    runner.run("LineOccupancy::select_blindly", window, platforms, [game]() { sink = sink + game->lines.select_blindly(game->generator); });
+    const BoundingBox avoidance{game->player->x, game->player->y, game->player->x + game->player->w, game->player->y + game->player->h};
+    runner.run("generate_platforms", window, platforms, [game, &avoidance, platforms]() {
+      const auto generated = generate_platforms(*game->settings, game->box, avoidance, platforms, game->tile_w, game->tile_h, game->generator);
+      sink = sink + generated.size();
+    });
+  }
+}
+
+/**
+ * Rasterizes a frame like the ones of the game offscreen, on one thread and on all of them.
+ */
+static void run_rasterizer_benchmarks(BenchmarkRunner &runner, U32 width, U32 height, U32 platforms) {
+  const std::string window = std::to_string(width) + "x" + std::to_string(height);
+  Fixture fixture(width, height, platforms);
+  const Game *game = fixture.game.get();
+  const Settings &settings = fixture.settings;
+  const auto w = static_cast<int>(settings.get_window_width());
+  const auto h = static_cast<int>(settings.get_window_height());
+  const auto bar_height = static_cast<int>(settings.get_bar_height());
+  RenderList list;
+  list.add_rectangle(RENDER_LAYER_BARS, 0, 0, w, bar_height, Color(34, 34, 34, 255));
+  list.add_rectangle(RENDER_LAYER_BARS, 0, h - bar_height, w, bar_height, Color(34, 34, 34, 255));
+  for (size_t i = 0; i < game->platforms.size(); i++) {
+    const Platform platform = game->platforms.get(i);
+    list.add_rectangle(RENDER_LAYER_PLATFORMS, platform.x, platform.y, platform.w, platform.h, Color(128, 102, 153, 255));
+  }
+  const Player *player = game->player;
+  for (int i = 1; i <= 8; i++) {
+    const auto alpha = static_cast<U8>(255 - 28 * i);
+    list.add_blended_rectangle(RENDER_LAYER_TRAIL, player->x - i * game->tile_w, player->y, player->w, player->h, Color(204, 204, 204, alpha));
+  }
+  std::vector<U32> pixels(static_cast<size_t>(w) * h);
+  std::vector<unsigned> band_counts = {1};
+  if (std::thread::hardware_concurrency() > 1) {
+    band_counts.push_back(std::thread::hardware_concurrency());
+  }
+  for (const unsigned bands : band_counts) {
+    Rasterizer rasterizer(w, h, bands, nullptr);
+    rasterizer.set_target(pixels.data(), w * static_cast<int>(sizeof(U32)));
+    const std::string name = "RenderList::submit(Rasterizer) " + std::to_string(rasterizer.get_band_count()) + " bands";
+    runner.run(name, window, platforms, [&list, &rasterizer]() { sink = sink + list.submit(rasterizer, Color(0, 0, 0, 255)).rectangles; });
+  }
+}
+
+static void run_bookkeeping_benchmarks(BenchmarkRunner &runner) {
+  RecordTable table(default_record_table_size);
+  Score score = 0;
+  runner.run("RecordTable::add_record", "none", 0, [&table, &score]() {
+    score = (score + 7919) % 100000;
+    sink = sink + table.add_record(Record("Benchmark", score));
+  });
+  runner.run("RecordTable::dump", "none", 0, [&table]() { table.dump(records_filename); });
+  runner.run("RecordTable::load", "none", 0, [&table]() {
+    table.load(records_filename);
+    sink = sink + table.size();
+  });
+  remove(records_filename);
+  Profiler profiler(true);
+  runner.run("Profiler::start/stop", "none", 0, [&profiler]() {
+    profiler.start("benchmark");
+    profiler.stop();
+  });
+}
+
+static BenchmarkOptions parse_options(int argc, char *argv[]) {
+  BenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (string_equals(argv[i], "--filter") && has_value) {
+      options.filter = argv[++i];
+    } else if (string_equals(argv[i], "--output") && has_value) {
+      options.output = argv[++i];
+    } else if (string_equals(argv[i], "--samples") && has_value) {
+      options.samples = std::max(1ULL, string_to_unsigned(argv[++i]));
+    } else {
+      throw std::invalid_argument(std::string("Unrecognized argument: ") + argv[i] + ".");
+    }
+  }
+  return options;
+}
+
+/**
+ * Runs the microbenchmarks of the simulation and drawing hot paths for several window sizes and platform counts.
+ *
+ * Writes the statistics as JSON to the standard output or to the file passed with --output.
+ */
+int main(int argc, char *argv[]) {
+  try {
+    const BenchmarkOptions options = parse_options(argc, argv);
+    BenchmarkRunner runner(options);
+    const U32 windows[3][2] = {{1280, 720}, {1920, 1080}, {3840, 2160}};
+    const U32 platform_counts[3] = {16, 64, 256};
+    for (const auto &window : windows) {
+      for (const U32 platforms : platform_counts) {
+        run_game_benchmarks(runner, window[0], window[1], platforms);
+      }
+      run_rasterizer_benchmarks(runner, window[0], window[1], platform_counts[0]);
+    }
+    run_bookkeeping_benchmarks(runner);
+    if (options.output.empty()) {
+      runner.write_json(std::cout);
+    } else {
+      std::ofstream file(options.output);
+      if (!file) {
+        throw std::runtime_error("Could not write to " + options.output + ".");
+      }
+      runner.write_json(file);
+    }
+  } catch (std::exception &exception) {
+    std::cerr << "Exception!" << ' ' << exception.what() << '\n';
+    std::cerr << "Usage: benchmarks [--filter NAME] [--samples N] [--output FILE]" << '\n';
+    return 1;
+  }
+  return 0;
+}
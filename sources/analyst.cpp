@@ -9,7 +9,7 @@
 static F64 get_average_width(const Game &game) {
   F64 total = 0.0;
   for (size_t i = game.platform_count - 1; i != 0u; --i) {
-    total += game.platforms[i].w;
+    total += game.platforms.w[i];
   }
   return total / static_cast<F64>(game.platform_count);
 }
@@ -17,9 +17,9 @@ static F64 get_average_width(const Game &game) {
 static F64 get_average_speed(const Game &game) {
   F64 total = 0.0;
   for (size_t i = game.platform_count - 1; i != 0u; --i) {
-    total += abs(game.platforms[i].speed);
+    total += abs(game.platforms.speed[i]);
   }
-  return total / static_cast<F64>(game.platform_count);
+  return total / static_cast<F64>(game.platform_count) / SUBPIXELS_PER_PIXEL;
 }
 
 F64 get_difficulty(const Game &game) {
@@ -0,0 +1,237 @@
+#include "analyst.hpp"
+#include "game.hpp"
+#include "profiler.hpp"
+#include "settings.hpp"
+#include "simulation.hpp"
+#include "text.hpp"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DEFAULT_LIMIT_PLAYED_TICKS (2 * 60 * UPS)
+
+/**
+ * A settings key and the values it takes in the sweep.
+ */
+class SweepAxis {
+public:
+  std::string key;
+  std::vector<std::string> values;
+};
+
+class BatchOptions {
+public:
+  U64 games = 100;
+  U64 ticks = DEFAULT_LIMIT_PLAYED_TICKS;
+  U64 seed = 1;
+  U32 threads = 0;
+  U32 display_width = 1920;
+  U32 display_height = 1080;
+  std::string output;
+  std::vector<SweepAxis> axes;
+};
+
+/**
+ * One game of the batch, which runs the configuration with the provided index on the provided seed.
+ */
+class BatchTask {
+public:
+  size_t configuration;
+  U64 seed;
+};
+
+class BatchOutcome {
+public:
+  SimulationResult result;
+  F64 difficulty = 0.0;
+};
+
+static const char *usage = "Usage: walls-of-doom-batch [--games N] [--ticks N] [--seed N] [--threads N] [--display WIDTH HEIGHT] "
+                           "[--set KEY=VALUE,VALUE,...]... [--output FILE]";
+
+static SweepAxis parse_axis(const std::string &text) {
+  const auto separator = text.find('=');
+  if (separator == std::string::npos || separator == 0 || separator + 1 == text.size()) {
+    throw std::invalid_argument("Expected KEY=VALUE,VALUE,... but got " + text + ".");
+  }
+  SweepAxis axis;
+  axis.key = text.substr(0, separator);
+  size_t begin = separator + 1;
+  while (begin <= text.size()) {
+    auto end = text.find(',', begin);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    axis.values.push_back(text.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  return axis;
+}
+
+static BatchOptions parse_options(int argc, char *argv[]) {
+  BatchOptions options;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (string_equals(argv[i], "--games") && has_value) {
+      options.games = string_to_unsigned(argv[++i]);
+    } else if (string_equals(argv[i], "--ticks") && has_value) {
+      options.ticks = string_to_unsigned(argv[++i]);
+    } else if (string_equals(argv[i], "--seed") && has_value) {
+      options.seed = string_to_unsigned(argv[++i]);
+    } else if (string_equals(argv[i], "--threads") && has_value) {
+      options.threads = static_cast<U32>(string_to_unsigned(argv[++i]));
+    } else if (string_equals(argv[i], "--display") && i + 2 < argc) {
+      options.display_width = static_cast<U32>(string_to_unsigned(argv[++i]));
+      options.display_height = static_cast<U32>(string_to_unsigned(argv[++i]));
+    } else if (string_equals(argv[i], "--set") && has_value) {
+      options.axes.push_back(parse_axis(argv[++i]));
+    } else if (string_equals(argv[i], "--output") && has_value) {
+      options.output = argv[++i];
+    } else {
+      throw std::invalid_argument(std::string("Unrecognized argument: ") + argv[i] + ".");
+    }
+  }
+  if (options.threads == 0) {
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return options;
+}
+
+/**
+ * Returns the value each axis takes in the configuration with the provided index.
+ *
+ * Configurations enumerate the cartesian product of the axes, with the last axis changing fastest.
+ */
+static std::vector<std::string> get_configuration_values(const std::vector<SweepAxis> &axes, size_t configuration) {
+  std::vector<std::string> values(axes.size());
+  for (size_t i = axes.size(); i-- > 0;) {
+    values[i] = axes[i].values[configuration % axes[i].values.size()];
+    configuration /= axes[i].values.size();
+  }
+  return values;
+}
+
+static std::vector<Settings> make_configurations(const BatchOptions &options) {
+  size_t count = 1;
+  for (const SweepAxis &axis : options.axes) {
+    count *= axis.values.size();
+  }
+  std::vector<Settings> configurations;
+  for (size_t i = 0; i < count; i++) {
+    Settings settings(settings_filename);
+    const std::vector<std::string> values = get_configuration_values(options.axes, i);
+    for (size_t j = 0; j < options.axes.size(); j++) {
+      settings.set(options.axes[j].key.c_str(), values[j].c_str());
+    }
+    settings.compute_window_size(options.display_width, options.display_height);
+    configurations.push_back(settings);
+  }
+  return configurations;
+}
+
+static BatchOutcome run_task(const Settings &settings, const BatchTask &task, const U64 ticks) {
+  CommandTable table{};
+  initialize_command_table(&table);
+  Player player("Batch", &table);
+  Profiler profiler(false);
+  Game game(&player, &settings, &profiler, task.seed);
+  SimulationInput input(INPUT_MODE_RANDOM, static_cast<U32>(task.seed));
+  BatchOutcome outcome;
+  outcome.difficulty = get_difficulty(game);
+  outcome.result = run_simulation(&game, input, ticks, false);
+  return outcome;
+}
+
+static void write_outcomes(std::ostream &stream, const BatchOptions &options, const std::vector<BatchTask> &tasks,
+                           const std::vector<BatchOutcome> &outcomes) {
+  stream << "Configuration";
+  for (const SweepAxis &axis : options.axes) {
+    stream << ',' << axis.key;
+  }
+  stream << ",Seed,Survival Frames,Ticks,Lives,Score,Difficulty,Ticks per Second" << '\n';
+  for (size_t i = 0; i < tasks.size(); i++) {
+    const SimulationResult &result = outcomes[i].result;
+    stream << tasks[i].configuration;
+    for (const std::string &value : get_configuration_values(options.axes, tasks[i].configuration)) {
+      stream << ',' << value;
+    }
+    stream << ',' << tasks[i].seed << ',' << result.played_frames << ',' << result.ticks << ',' << result.lives;
+    stream << ',' << result.score << ',' << double_to_string(outcomes[i].difficulty, 4);
+    stream << ',' << double_to_string(result.get_ticks_per_second(), 0) << '\n';
+  }
+}
+
+/**
+ * Runs many headless games, spread over a pool of threads, and writes the outcome of each one as CSV.
+ *
+ * Every configuration of the sweep plays the same seeds, so that configurations can be compared game by game.
+ */
+int main(int argc, char *argv[]) {
+  try {
+    const BatchOptions options = parse_options(argc, argv);
+    const std::vector<Settings> configurations = make_configurations(options);
+    std::vector<BatchTask> tasks;
+    for (size_t i = 0; i < configurations.size(); i++) {
+      for (U64 j = 0; j < options.games; j++) {
+        tasks.push_back(BatchTask{i, options.seed + j});
+      }
+    }
+    std::vector<BatchOutcome> outcomes(tasks.size());
+    std::atomic<size_t> next_task(0);
+    /* An exception escaping a thread would terminate the program, so each worker keeps its own until all of them joined. */
+    std::vector<std::exception_ptr> errors(options.threads);
+    const auto work = [&](const U32 worker) {
+      try {
+        for (size_t i = next_task++; i < tasks.size(); i = next_task++) {
+          outcomes[i] = run_task(configurations[tasks[i].configuration], tasks[i], options.ticks);
+        }
+      } catch (...) {
+        errors[worker] = std::current_exception();
+        /* Leave no tasks for the other workers, as the batch failed anyway. */
+        next_task = tasks.size();
+      }
+    };
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (U32 i = 0; i < options.threads; i++) {
+      workers.emplace_back(work, i);
+    }
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+    for (const std::exception_ptr &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    U64 total_ticks = 0;
+    for (const BatchOutcome &outcome : outcomes) {
+      total_ticks += outcome.result.ticks;
+    }
+    if (options.output.empty()) {
+      write_outcomes(std::cout, options, tasks, outcomes);
+    } else {
+      std::ofstream file(options.output);
+      if (!file) {
+        throw std::runtime_error("Could not write to " + options.output + ".");
+      }
+      write_outcomes(file, options, tasks, outcomes);
+    }
+    std::cerr << "Ran " << tasks.size() << " games on " << options.threads << " threads in " << double_to_string(elapsed.count(), 3);
+    std::cerr << " s (" << double_to_string(total_ticks / elapsed.count(), 0) << " ticks/s)." << '\n';
+  } catch (std::invalid_argument &exception) {
+    std::cerr << exception.what() << '\n' << usage << '\n';
+    return 1;
+  } catch (std::exception &exception) {
+    std::cerr << "Exception!" << ' ' << exception.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "collider.hpp"
+#include <algorithm>
+#include <atomic>
+
+/* How many versions each collider has before it could reach the versions of the next one. */
+static const U64 versions_per_collider = 1ULL << 40;
+
+/* Colliders are created on many threads by the batch runner, so the first versions are handed out atomically. */
+static std::atomic<U64> next_initial_version{versions_per_collider};
+
+Collider::Collider(CollisionBackend backend, BoundingBox box, int line_height) : backend(backend) {
+  min_y = box.min_y;
+  initial_version = next_initial_version.fetch_add(versions_per_collider);
+  last_version = initial_version;
+  row_versions.assign(static_cast<size_t>(box.max_y - box.min_y + 1), initial_version);
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    line_index = LineIndex(box, line_height);
+  } else {
+    rigid_matrix = RigidMatrix(box);
+  }
+}
+
+U8 Collider::get(int x, int y) const {
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    return line_index.get(x, y);
+  }
+  return rigid_matrix.get(x, y);
+}
+
+void Collider::modify(int x, int y, int w, int h, S8 delta) {
+  const int first_row = std::max(0, y - min_y);
+  const int end_row = std::min(static_cast<int>(row_versions.size()), y + h - min_y);
+  last_version++;
+  for (int row = first_row; row < end_row; row++) {
+    row_versions[row] = last_version;
+  }
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    line_index.modify(x, y, w, h, delta);
+  } else {
+    rigid_matrix.modify(x, y, w, h, delta);
+  }
+}
+
+bool Collider::is_free(int x, int y, int w, int h) const {
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    return line_index.is_free(x, y, w, h);
+  }
+  return rigid_matrix.is_free(x, y, w, h);
+}
+
+int Collider::count_free_columns(int x, int y, int h, int direction, int limit) const {
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    return line_index.count_free_columns(x, y, h, direction, limit);
+  }
+  return rigid_matrix.count_free_columns(x, y, h, direction, limit);
+}
+
+int Collider::count_free_rows(int x, int y, int w, int direction, int limit) const {
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    return line_index.count_free_rows(x, y, w, direction, limit);
+  }
+  return rigid_matrix.count_free_rows(x, y, w, direction, limit);
+}
+
+int Collider::sweep(int x, int y, int w, int h, int dx, int dy, int limit) const {
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    return line_index.sweep(x, y, w, h, dx, dy, limit);
+  }
+  return rigid_matrix.sweep(x, y, w, h, dx, dy, limit);
+}
+
+size_t Collider::get_memory_usage() const {
+  const size_t versions = row_versions.capacity() * sizeof(U64);
+  if (backend == COLLISION_BACKEND_LINE_INDEX) {
+    return versions + line_index.get_memory_usage();
+  }
+  return versions + rigid_matrix.get_memory_usage();
+}
@@ -0,0 +1,68 @@
+#ifndef COLLIDER_H
+#define COLLIDER_H
+
+#include "box.hpp"
+#include "integers.hpp"
+#include "line_index.hpp"
+#include "rigid_matrix.hpp"
+#include "settings.hpp"
+#include <vector>
+
+/**
+ * Answers the collision queries of the physics using the backend selected in the settings.
+ *
+ * Both backends give the same answers, so they can be swapped to compare their performance.
+ */
+class Collider {
+public:
+  Collider() = default;
+
+  Collider(CollisionBackend backend, BoundingBox box, int line_height);
+
+  inline CollisionBackend get_backend() const {
+    return backend;
+  }
+
+  U8 get(int x, int y) const;
+
+  /**
+   * Adds delta to the count of every cell of the rectangle and gives the rows it spans a new version.
+   */
+  void modify(int x, int y, int w, int h, S8 delta);
+
+  /**
+   * Returns the version of a row of cells, which changes whenever the row is modified.
+   *
+   * Versions are never reused, not even by another collider, so a copy of a row tagged with its version stays valid for
+   * as long as the version does not change.
+   */
+  inline U64 get_row_version(int y) const {
+    const int row = y - min_y;
+    if (row < 0 || row >= static_cast<int>(row_versions.size())) {
+      return initial_version;
+    }
+    return row_versions[row];
+  }
+
+  bool is_free(int x, int y, int w, int h) const;
+
+  int count_free_columns(int x, int y, int h, int direction, int limit) const;
+
+  int count_free_rows(int x, int y, int w, int direction, int limit) const;
+
+  int sweep(int x, int y, int w, int h, int dx, int dy, int limit) const;
+
+  size_t get_memory_usage() const;
+
+private:
+  CollisionBackend backend = COLLISION_BACKEND_RIGID_MATRIX;
+  RigidMatrix rigid_matrix;
+  LineIndex line_index;
+  int min_y = 0;
+  // The version of the rows which were never modified, which is also the first of the versions of this collider.
+  U64 initial_version = 0;
+  U64 last_version = 0;
+  std::vector<U64> row_versions;
+};
+
+#endif
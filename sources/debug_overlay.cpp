@@ -0,0 +1,79 @@
+#include "debug_overlay.hpp"
+
+/* White at half opacity, in ARGB8888. */
+static const U32 occupied_pixel = 0x7FFFFFFF;
+static const U32 free_pixel = 0x00000000;
+
+DebugOverlay::~DebugOverlay() {
+  if (texture != nullptr) {
+    SDL_DestroyTexture(texture);
+  }
+}
+
+void DebugOverlay::upload(const RenderSnapshot &snapshot, const size_t first_row, const size_t end_row) {
+  const auto width = static_cast<size_t>(w);
+  pixels.resize((end_row - first_row) * width);
+  const U8 *occupancy = snapshot.collider.data() + first_row * width;
+  for (size_t i = 0; i < pixels.size(); i++) {
+    pixels[i] = occupancy[i] != 0u ? occupied_pixel : free_pixel;
+  }
+  SDL_Rect rectangle{};
+  rectangle.y = static_cast<int>(first_row);
+  rectangle.w = w;
+  rectangle.h = static_cast<int>(end_row - first_row);
+  SDL_UpdateTexture(texture, &rectangle, pixels.data(), static_cast<int>(width * sizeof(U32)));
+  for (size_t row = first_row; row < end_row; row++) {
+    versions[row] = snapshot.collider_versions[row];
+  }
+}
+
+U64 DebugOverlay::update(const RenderSnapshot &snapshot, SDL_Renderer *renderer) {
+  if (texture == nullptr || w != snapshot.view_width || h != snapshot.view_height) {
+    if (texture != nullptr) {
+      SDL_DestroyTexture(texture);
+    }
+    w = snapshot.view_width;
+    h = snapshot.view_height;
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+    if (texture == nullptr) {
+      return 0;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    versions.assign(static_cast<size_t>(h), 0);
+  }
+  if (origin.x != snapshot.collider_origin.x || origin.y != snapshot.collider_origin.y) {
+    origin = snapshot.collider_origin;
+    versions.assign(static_cast<size_t>(h), 0);
+  }
+  if (snapshot.collider_versions.size() != versions.size()) {
+    return 0;
+  }
+  /* Upload each run of consecutive rows which changed with a single call. */
+  U64 uploaded = 0;
+  size_t row = 0;
+  while (row < versions.size()) {
+    if (versions[row] == snapshot.collider_versions[row]) {
+      row++;
+      continue;
+    }
+    const size_t first_row = row;
+    while (row < versions.size() && versions[row] != snapshot.collider_versions[row]) {
+      row++;
+    }
+    upload(snapshot, first_row, row);
+    uploaded += row - first_row;
+  }
+  return uploaded;
+}
+
+void DebugOverlay::draw(const int x, const int y, SDL_Renderer *renderer) const {
+  if (texture == nullptr) {
+    return;
+  }
+  SDL_Rect destination{};
+  destination.x = x;
+  destination.y = y;
+  destination.w = w;
+  destination.h = h;
+  SDL_RenderCopy(renderer, texture, nullptr, &destination);
+}
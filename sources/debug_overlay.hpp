@@ -0,0 +1,46 @@
+#ifndef DEBUG_OVERLAY_H
+#define DEBUG_OVERLAY_H
+
+#include "integers.hpp"
+#include "point.hpp"
+#include "render_snapshot.hpp"
+#include <SDL.h>
+#include <vector>
+
+/**
+ * A streaming texture holding the occupancy of the view, drawn over the game while debugging.
+ *
+ * The texture keeps the collider version of each of its rows, so updating it only uploads the rows of a snapshot which
+ * changed since they were last uploaded. When the view moves, every row is uploaded again.
+ */
+class DebugOverlay {
+public:
+  DebugOverlay() = default;
+
+  ~DebugOverlay();
+
+  DebugOverlay(const DebugOverlay &) = delete;
+  DebugOverlay &operator=(const DebugOverlay &) = delete;
+
+  /**
+   * Uploads the rows of the snapshot collider which the texture does not have. Returns how many rows were uploaded.
+   */
+  U64 update(const RenderSnapshot &snapshot, SDL_Renderer *renderer);
+
+  /**
+   * Draws the texture with its top left corner at (x, y).
+   */
+  void draw(int x, int y, SDL_Renderer *renderer) const;
+
+private:
+  void upload(const RenderSnapshot &snapshot, size_t first_row, size_t end_row);
+
+  SDL_Texture *texture = nullptr;
+  int w = 0;
+  int h = 0;
+  Point origin;
+  std::vector<U64> versions;
+  std::vector<U32> pixels;
+};
+
+#endif
@@ -1,9 +1,22 @@
 #include "game.hpp"
 #include "analyst.hpp"
+#include "data.hpp"
 #include "io.hpp"
+#include "physics.hpp"
 #include "record_table.hpp"
+#include "render_snapshot.hpp"
+#include "replay.hpp"
+#include "snapshot_interpolator.hpp"
+#include "spsc_queue.hpp"
 #include "text.hpp"
+#include "triple_buffer.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <exception>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
 
 #define DEFAULT_LIMIT_PLAYED_MINUTES 2
 #define DEFAULT_LIMIT_PLAYED_SECONDS (DEFAULT_LIMIT_PLAYED_MINUTES * 60)
@@ -12,14 +25,18 @@
 static const Milliseconds register_score_release_delay = 200;
 static const Milliseconds milliseconds_in_a_second = 1000;
 static const int maximum_fps = 250;
+// How many command changes may wait for the simulation thread, which is far more than a frame of input holds.
+static const size_t command_queue_capacity = 256;
 
 static void initialize_rigid_matrix(Game *game) {
   for (size_t i = 0; i < game->platform_count; i++) {
-    modify_rigid_matrix_platform(game, game->platforms.data() + i, 1);
+    const Platform platform = game->platforms.get(i);
+    modify_rigid_matrix_platform(game, i, &platform, 1);
   }
 }
 
-Game::Game(Player *player, const Settings *settings, Profiler *profiler) : player(player), settings(settings), profiler(profiler) {
+Game::Game(Player *player, const Settings *settings, Profiler *profiler, U64 seed)
+    : player(player), settings(settings), profiler(profiler), seed(seed), generator(seed) {
   tile_w = settings->get_tile_w();
   tile_h = settings->get_tile_h();
 
@@ -27,15 +44,15 @@ Game::Game(Player *player, const Settings *settings, Profiler *profiler) : playe
 
   box.min_x = 0;
   box.min_y = 0;
-  box.max_x = settings->get_window_width();
-  box.max_y = settings->get_window_height() - 2 * settings->get_bar_height();
+  box.max_x = settings->get_playfield_width();
+  box.max_y = settings->get_playfield_height();
 
   player->w = tile_w;
   player->h = tile_h;
   reposition_player(this);
 
   const BoundingBox avoidance{player->x, player->y, player->x + player->w, player->y + player->h};
-  platforms = generate_platforms(*settings, box, avoidance, platform_count, tile_w, tile_h);
+  platforms = PlatformStore(generate_platforms(*settings, box, avoidance, platform_count, tile_w, tile_h, generator));
 
   current_frame = 0;
   desired_frame = 0;
@@ -49,16 +66,81 @@ Game::Game(Player *player, const Settings *settings, Profiler *profiler) : playe
   /* Don't start with a Perk on the screen. */
   perk_end_frame = static_cast<U64>(settings->get_perk_screen_duration() * UPS);
 
-  rigid_matrix_m = static_cast<size_t>(box.max_y - box.min_y + 1);
-  rigid_matrix_n = static_cast<size_t>(box.max_x - box.min_x + 1);
-  rigid_matrix.resize(rigid_matrix_m * rigid_matrix_n);
+  collider = Collider(settings->get_collision_backend(), box, tile_h);
+  lines = LineOccupancy(static_cast<U32>((box.max_y - box.min_y + 1) / tile_h));
+  line_platforms = LineBuckets(lines.get_line_count());
   initialize_rigid_matrix(this);
 
   message[0] = '\0';
   message_end_frame = 0;
   message_priority = 0;
 
-  log_message("Finished creating the game.");
+  log_message("Finished creating the game with seed " + std::to_string(seed) + ".");
+}
+
+GameSnapshot Game::snapshot() const {
+  GameSnapshot snapshot;
+  snapshot.platforms = platforms;
+  snapshot.current_frame = current_frame;
+  snapshot.desired_frame = desired_frame;
+  snapshot.played_frames = played_frames;
+  snapshot.perk = perk;
+  snapshot.perk_x = perk_x;
+  snapshot.perk_y = perk_y;
+  snapshot.perk_end_frame = perk_end_frame;
+  snapshot.generator = generator;
+  copy_string(snapshot.message, message, MAXIMUM_STRING_SIZE);
+  snapshot.message_end_frame = message_end_frame;
+  snapshot.message_priority = message_priority;
+  snapshot.player = player->snapshot();
+  return snapshot;
+}
+
+void Game::restore(const GameSnapshot &snapshot) {
+  if (snapshot.platforms.size() != platforms.size()) {
+    throw std::logic_error("Snapshot is from another game.");
+  }
+  /* Only move the platforms which differ, so that restoring a recent snapshot is cheap. */
+  for (size_t i = 0; i < platforms.size(); i++) {
+    Platform platform = platforms.get(i);
+    const Platform target = snapshot.platforms.get(i);
+    if (platform == target) {
+      continue;
+    }
+    if (platform.y == target.y && platform.w == target.w && platform.h == target.h && platform.x != target.x) {
+      slide_platform_on_x(this, &platform, target.x - platform.x);
+    } else {
+      modify_rigid_matrix_platform(this, i, &platform, -1);
+      modify_rigid_matrix_platform(this, i, &target, 1);
+    }
+    platforms.set(i, target);
+  }
+  current_frame = snapshot.current_frame;
+  desired_frame = snapshot.desired_frame;
+  played_frames = snapshot.played_frames;
+  perk = snapshot.perk;
+  perk_x = snapshot.perk_x;
+  perk_y = snapshot.perk_y;
+  perk_end_frame = snapshot.perk_end_frame;
+  generator = snapshot.generator;
+  copy_string(message, snapshot.message, MAXIMUM_STRING_SIZE);
+  message_end_frame = snapshot.message_end_frame;
+  message_priority = snapshot.message_priority;
+  player->restore(snapshot.player);
+}
+
+size_t Game::get_memory_usage() const {
+  size_t usage = platforms.get_memory_usage() + collider.get_memory_usage();
+  usage += lines.get_memory_usage() + line_platforms.get_memory_usage();
+  usage += sweep_order.capacity() * sizeof(U64);
+  return usage;
+}
+
+U64 get_game_seed(const Settings &settings) {
+  if (settings.get_random_seed() != 0) {
+    return settings.get_random_seed();
+  }
+  return get_time_seed();
 }
 
 Milliseconds update_game(Game *const game) {
@@ -135,61 +217,188 @@ Code register_score(const Game *const game, SDL_Renderer *renderer) {
   return code;
 }
 
+/**
+ * A change to the status of a command, which the main thread passes to the simulation thread.
+ */
+class CommandChange {
+public:
+  Command command = COMMAND_NONE;
+  double status = 0.0;
+};
+
+/**
+ * What the main thread and the simulation thread of a game share.
+ */
+class SharedGameState {
+public:
+  TripleBuffer<RenderSnapshot> snapshots;
+  SpscQueue<CommandChange> commands{command_queue_capacity};
+  std::atomic<bool> stopping{false};
+  std::atomic<bool> paused{false};
+  std::atomic<bool> debugging{false};
+  // Set by the simulation thread after it stored the exception which stopped it, so that the game ends right away.
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+};
+
+/**
+ * Runs the logic ticks of a game at UPS until it is over or the main thread stops it, publishing a snapshot after each
+ * batch of ticks.
+ *
+ * This is the only thread which touches the game while it runs.
+ */
+static void run_simulation_thread(Game *const game, SharedGameState *const shared, ReplayRecorder *const recorder) {
+  try {
+    const Milliseconds logic_interval = milliseconds_in_a_second / UPS;
+    Milliseconds next_tick = get_milliseconds();
+    CommandChange change;
+    bool finished = false;
+    while (!finished && !shared->stopping.load()) {
+      while (shared->commands.pop(change)) {
+        game->player->table->status[change.command] = change.status;
+      }
+      const Milliseconds now = get_milliseconds();
+      if (shared->paused.load()) {
+        next_tick = now + logic_interval;
+        sleep_milliseconds(logic_interval);
+        continue;
+      }
+      if (now < next_tick) {
+        sleep_milliseconds(next_tick - now);
+        continue;
+      }
+      if (now - next_tick >= 2 * logic_interval) {
+        std::cerr << "Skipped a frame!" << '\n';
+      }
+      while (next_tick <= now && !finished) {
+        next_tick += logic_interval;
+        game->desired_frame++;
+        if (recorder != nullptr) {
+          recorder->record_commands(*game);
+        }
+        update_game(game);
+        update_player(game, game->player);
+        game->current_frame++;
+        if (recorder != nullptr) {
+          recorder->record_hash(*game);
+        }
+        finished = is_game_over(*game);
+      }
+      game->profiler->start("capture_snapshot");
+      shared->snapshots.get_back().capture(*game, shared->debugging.load());
+      shared->snapshots.get_back().time = next_tick - logic_interval;
+      shared->snapshots.publish();
+      game->profiler->stop();
+    }
+  } catch (...) {
+    shared->error = std::current_exception();
+    shared->failed.store(true);
+  }
+}
+
+/**
+ * Sends the commands whose status changed since the last call to the simulation thread.
+ *
+ * Changes are sent even if the status is the same, so that a repeated key press jumps again.
+ */
+static void send_command_changes(const CommandTable &input, Milliseconds *const sent, SharedGameState *const shared) {
+  for (int i = 0; i < COMMAND_COUNT; i++) {
+    if (input.last_modified[i] != sent[i]) {
+      CommandChange change;
+      change.command = static_cast<Command>(i);
+      change.status = input.status[i];
+      if (shared->commands.push(change)) {
+        sent[i] = input.last_modified[i];
+      }
+    }
+  }
+}
+
 /**
  * Runs the main game loop for the Game object and registers the player score.
+ *
+ * The simulation runs on its own thread. This thread reads the input, which it passes on through a queue, and draws the
+ * latest snapshot which the simulation published, so a slow frame never delays a logic tick. If positions are
+ * interpolated, frames are also drawn between snapshots.
  */
 Code run_game(Game *const game, SDL_Renderer *renderer) {
   log_message("Started running a game of difficulty " + double_to_string(get_difficulty(*game), 4) + ".");
   const Milliseconds frame_interval = milliseconds_in_a_second / maximum_fps;
-  const Milliseconds logic_interval = milliseconds_in_a_second / UPS;
-  Milliseconds start_time = 0;
-  Milliseconds time_since_last_logic_update = 0;
   Code code = CODE_OK;
-  int *lives = &game->player->lives;
-  U64 limit = game->limit_played_frames;
-  CommandTable table{};
-  initialize_command_table(&table);
-  while ((game->player->table->status[COMMAND_QUIT] == 0.0) && *lives != 0 && game->played_frames < limit) {
-    start_time = get_milliseconds();
-    if (time_since_last_logic_update >= 2 * logic_interval) {
-      std::cerr << "Skipped a frame!" << '\n';
+  CommandTable input = *game->player->table;
+  Milliseconds sent[COMMAND_COUNT];
+  std::copy(std::begin(input.last_modified), std::end(input.last_modified), std::begin(sent));
+  const bool recording = game->settings->is_recording_replays();
+  ReplayRecorder recorder(*game);
+  Profiler profiler(game->profiler->is_active());
+  SharedGameState shared;
+  shared.snapshots.get_back().capture(*game, false);
+  shared.snapshots.get_back().time = get_milliseconds();
+  shared.snapshots.publish();
+  std::thread simulation(run_simulation_thread, game, &shared, recording ? &recorder : nullptr);
+  const bool interpolating = game->settings->is_interpolating_positions();
+  SnapshotInterpolator interpolator;
+  bool finished = false;
+  Milliseconds last_draw_time = 0;
+  while (input.status[COMMAND_QUIT] == 0.0 && !finished && !shared.failed.load()) {
+    const Milliseconds start_time = get_milliseconds();
+    const bool fresh = shared.snapshots.update();
+    if (fresh) {
+      finished = shared.snapshots.get_front().finished;
+      if (interpolating) {
+        interpolator.push(shared.snapshots.get_front());
+      }
     }
-    while (time_since_last_logic_update > logic_interval) {
-      time_since_last_logic_update -= logic_interval;
-      game->desired_frame++;
+    /* Only draw when something moved, as the screen already shows the last frame otherwise. */
+    const bool moving = interpolating && !interpolator.is_settled();
+    if (fresh || moving || start_time - last_draw_time >= milliseconds_in_a_second) {
+      if (interpolating) {
+        const RenderSnapshot &snapshot = interpolator.interpolate(start_time, game->tile_w, game->tile_h);
+        draw_game(*game->settings, snapshot, &profiler, renderer);
+      } else {
+        draw_game(*game->settings, shared.snapshots.get_front(), &profiler, renderer);
+      }
+      last_draw_time = start_time;
     }
-    if (game->paused) {
-      draw_game(game, renderer);
-      read_commands(*game->settings, game->player->table);
-      if (test_command_table(game->player->table, COMMAND_CLOSE, REPETITION_DELAY)) {
+    read_commands(*game->settings, &input);
+    if (shared.paused.load()) {
+      if (test_command_table(&input, COMMAND_CLOSE, REPETITION_DELAY)) {
         code = CODE_CLOSE;
       }
-      if (test_command_table(game->player->table, COMMAND_QUIT, REPETITION_DELAY)) {
+      if (test_command_table(&input, COMMAND_QUIT, REPETITION_DELAY)) {
         code = CODE_QUIT;
       }
-      if (test_command_table(game->player->table, COMMAND_PAUSE, REPETITION_DELAY)) {
-        game->paused = false;
+      if (test_command_table(&input, COMMAND_PAUSE, REPETITION_DELAY)) {
+        shared.paused.store(false);
+      }
+    } else {
+      if (test_command_table(&input, COMMAND_PAUSE, REPETITION_DELAY)) {
+        shared.paused.store(true);
+      }
+      if (test_command_table(&input, COMMAND_DEBUG, REPETITION_DELAY)) {
+        shared.debugging.store(!shared.debugging.load());
       }
-      continue;
-    }
-    while (game->current_frame < game->desired_frame) {
-      update_game(game);
-      update_player(game, game->player);
-      game->current_frame++;
-    }
-    draw_game(game, renderer);
-    read_commands(*game->settings, game->player->table);
-    if (test_command_table(game->player->table, COMMAND_PAUSE, REPETITION_DELAY)) {
-      game->paused = true;
-    }
-    if (test_command_table(game->player->table, COMMAND_DEBUG, REPETITION_DELAY)) {
-      game->debugging = !game->debugging;
     }
+    send_command_changes(input, sent, &shared);
     const auto time_since_last_frame_update = get_milliseconds() - start_time;
     if (time_since_last_frame_update < frame_interval) {
       sleep_milliseconds(frame_interval - time_since_last_frame_update);
     }
-    time_since_last_logic_update += get_milliseconds() - start_time;
+  }
+  shared.stopping.store(true);
+  simulation.join();
+  game->profiler->merge(profiler);
+  if (shared.error) {
+    std::rethrow_exception(shared.error);
+  }
+  *game->player->table = input;
+  if (recording) {
+    try {
+      recorder.get_replay().save(get_full_path(replay_filename));
+      log_message("Saved the replay of " + std::to_string(recorder.get_replay().get_tick_count()) + " ticks.");
+    } catch (std::runtime_error &error) {
+      log_message(error.what());
+    }
   }
   if (code != CODE_CLOSE) {
     code = register_score(game, renderer);
@@ -3,9 +3,11 @@
 
 #include "box.hpp"
 #include "clock.hpp"
+#include "collider.hpp"
 #include "code.hpp"
 #include "constants.hpp"
 #include "integers.hpp"
+#include "line_occupancy.hpp"
 #include "logger.hpp"
 #include "numeric.hpp"
 #include "perk.hpp"
@@ -18,6 +20,42 @@
 #include <cstdlib>
 #include <vector>
 
+/**
+ * The state of a Game and of its Player at the end of a tick.
+ *
+ * Only the platform list is kept. The collider is derived from it when restoring, so a snapshot is small and taking one
+ * does not copy the collider.
+ */
+class GameSnapshot {
+public:
+  PlatformStore platforms;
+  U64 current_frame;
+  U64 desired_frame;
+  U64 played_frames;
+  Perk perk;
+  int perk_x;
+  int perk_y;
+  U64 perk_end_frame;
+  RandomGenerator generator;
+  char message[MAXIMUM_STRING_SIZE];
+  U64 message_end_frame;
+  unsigned int message_priority;
+  PlayerSnapshot player;
+};
+
+/**
+ * What the player touches, recorded once after each movement of the player and read by the checks which follow it.
+ */
+class PlayerContact {
+public:
+  // Whether the player stands on a platform, or on the bottom border while invincible.
+  bool standing = false;
+  // Whether the player is outside of the box, which kills it.
+  bool touching_wall = false;
+  // The indices of the platforms directly below the player, in increasing order.
+  std::vector<U32> supports;
+};
+
 class Game {
 public:
   Player *player;
@@ -26,10 +64,13 @@ public:
 
   Profiler *profiler;
 
-  std::vector<Platform> platforms;
+  PlatformStore platforms;
 
   size_t platform_count;
 
+  // The platforms of a line sorted by where they begin, kept to avoid allocating on every tick.
+  std::vector<U64> sweep_order;
+
   U64 current_frame;
   U64 desired_frame;
 
@@ -37,9 +78,6 @@ public:
   U64 played_frames;
   U64 limit_played_frames;
 
-  bool paused = false;
-  bool debugging = false;
-
   int tile_w;
   int tile_h;
 
@@ -50,44 +88,66 @@ public:
 
   BoundingBox box;
 
-  size_t rigid_matrix_n;
-  size_t rigid_matrix_m;
-  size_t rigid_matrix_size{};
-  std::vector<U8> rigid_matrix;
+  Collider collider;
+
+  // How many platforms are on each tile line, and which ones.
+  LineOccupancy lines;
+  LineBuckets line_platforms;
+
+  PlayerContact contact;
+
+  U64 seed;
+  RandomGenerator generator;
 
   char message[MAXIMUM_STRING_SIZE]{};
   U64 message_end_frame;
   unsigned int message_priority;
 
-  Game(Player *player, const Settings *settings, Profiler *profiler);
+  Game(Player *player, const Settings *settings, Profiler *profiler, U64 seed);
+
+  GameSnapshot snapshot() const;
+
+  /**
+   * Returns how many bytes the platforms, the collider and the line indices of this game use.
+   */
+  size_t get_memory_usage() const;
+
+  /**
+   * Restores a snapshot of this game, which takes time proportional to the area of the platforms that moved.
+   */
+  void restore(const GameSnapshot &snapshot);
 };
 
-Milliseconds update_game(Game *const game);
+/**
+ * Returns the seed for a new game, which is the one in the settings or, if there is none, one derived from the clock.
+ */
+U64 get_game_seed(const Settings &settings);
 
-inline size_t get_rigid_matrix_index(const Game *const game, const int x, const int y) {
-  const int base_x = x - game->box.min_x;
-  const int base_y = y - game->box.min_y;
-  return base_x + base_y * game->rigid_matrix_n;
-}
+Milliseconds update_game(Game *const game);
 
 inline unsigned char get_from_rigid_matrix(const Game *const game, const int x, const int y) {
-  if (game->box.contains(x, y)) {
-    return game->rigid_matrix[get_rigid_matrix_index(game, x, y)];
-  }
-  return 0;
+  return game->collider.get(x, y);
 }
 
-inline void modify_rigid_matrix_point(Game *const game, const int x, const int y, S8 delta) {
-  if (game->box.contains(x, y)) {
-    safe_add(game->rigid_matrix[get_rigid_matrix_index(game, x, y)], delta);
-  }
+inline U32 get_platform_line(const Game *const game, Platform const *platform) {
+  return static_cast<U32>((platform->y - game->box.min_y) / game->tile_h);
 }
 
-inline void modify_rigid_matrix_platform(Game *game, Platform const *platform, S8 delta) {
-  for (int x = 0; x < platform->w; ++x) {
-    for (int y = 0; y < platform->h; ++y) {
-      modify_rigid_matrix_point(game, platform->x + x, platform->y + y, delta);
-    }
+/**
+ * Adds the platform with the provided index to the collider and to the line indices if delta is positive, or removes it
+ * if delta is negative.
+ *
+ * The platform is passed separately from its index because the physics works on a copy of it while it moves.
+ */
+inline void modify_rigid_matrix_platform(Game *game, size_t index, Platform const *platform, S8 delta) {
+  game->collider.modify(platform->x, platform->y, platform->w, platform->h, delta);
+  const U32 line = get_platform_line(game, platform);
+  if (delta > 0) {
+    game->lines.add(line);
+    game->line_platforms.add(line, index);
+  } else {
+    game->lines.remove(line);
+    game->line_platforms.remove(line, index);
   }
 }
 
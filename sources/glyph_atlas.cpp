@@ -0,0 +1,112 @@
+#include "glyph_atlas.hpp"
+#include <stdexcept>
+
+/* The masks of a 32-bit surface with alpha, which do not depend on the byte order because they are whole words. */
+static const Uint32 red_mask = 0x00FF0000;
+static const Uint32 green_mask = 0x0000FF00;
+static const Uint32 blue_mask = 0x000000FF;
+static const Uint32 alpha_mask = 0xFF000000;
+
+static bool is_control_character(const int character) {
+  return character == 127 || (character >= 128 && character < 160);
+}
+
+GlyphAtlas::GlyphAtlas(TTF_Font *font, const int glyph_width, const int glyph_height, SDL_Renderer *renderer)
+    : glyph_width(glyph_width), glyph_height(glyph_height) {
+  const int count = last_character - first_character + 1;
+  const int rows = (count + columns - 1) / columns;
+  SDL_Surface *atlas = SDL_CreateRGBSurface(0, columns * glyph_width, rows * glyph_height, 32, red_mask, green_mask, blue_mask, alpha_mask);
+  if (atlas == nullptr) {
+    throw std::runtime_error("Failed to create the glyph atlas surface.");
+  }
+  SDL_Color white{};
+  white.r = 255;
+  white.g = 255;
+  white.b = 255;
+  white.a = 255;
+  for (int i = 0; i < count; i++) {
+    const int character = first_character + i;
+    if (is_control_character(character)) {
+      continue;
+    }
+    SDL_Surface *glyph = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(character), white);
+    /* A font without this glyph leaves its cell blank. */
+    if (glyph == nullptr) {
+      continue;
+    }
+    /* Copy the alpha of the glyph instead of blending it over the transparent atlas. */
+    SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+    SDL_Rect source{};
+    source.w = glyph_width;
+    source.h = glyph_height;
+    SDL_Rect destination{};
+    destination.x = (i % columns) * glyph_width;
+    destination.y = (i / columns) * glyph_height;
+    SDL_BlitSurface(glyph, &source, atlas, &destination);
+    SDL_FreeSurface(glyph);
+  }
+  coverage.resize(static_cast<size_t>(atlas->w) * atlas->h);
+  for (int y = 0; y < atlas->h; y++) {
+    const U8 *row = static_cast<const U8 *>(atlas->pixels) + static_cast<size_t>(y) * atlas->pitch;
+    for (int x = 0; x < atlas->w; x++) {
+      Uint32 pixel;
+      memcpy(&pixel, row + x * sizeof(Uint32), sizeof(Uint32));
+      coverage[static_cast<size_t>(y) * atlas->w + x] = static_cast<U8>((pixel & alpha_mask) >> 24);
+    }
+  }
+  texture = SDL_CreateTextureFromSurface(renderer, atlas);
+  SDL_FreeSurface(atlas);
+  if (texture == nullptr) {
+    throw std::runtime_error("Failed to create the glyph atlas texture.");
+  }
+  SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+}
+
+GlyphAtlas::~GlyphAtlas() {
+  SDL_DestroyTexture(texture);
+}
+
+const U8 *GlyphAtlas::get_coverage(const int character) const {
+  if (character < first_character || character > last_character || is_control_character(character)) {
+    return nullptr;
+  }
+  const int i = character - first_character;
+  return coverage.data() + static_cast<size_t>((i / columns) * glyph_height) * get_coverage_pitch() + (i % columns) * glyph_width;
+}
+
+void GlyphAtlas::draw(const int x, const int y, const char *string, const ColorPair color, SDL_Renderer *renderer) const {
+  SDL_Rect destination{};
+  destination.x = x;
+  destination.y = y;
+  destination.w = get_width(string);
+  destination.h = glyph_height;
+  /* Fill the background opaquely, as shaded text rendering does. */
+  SDL_BlendMode blend_mode;
+  Uint8 r;
+  Uint8 g;
+  Uint8 b;
+  Uint8 a;
+  SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+  SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+  SDL_SetRenderDrawColor(renderer, color.background.r, color.background.g, color.background.b, 255);
+  SDL_RenderFillRect(renderer, &destination);
+  SDL_SetRenderDrawColor(renderer, r, g, b, a);
+  SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+  SDL_SetTextureColorMod(texture, color.foreground.r, color.foreground.g, color.foreground.b);
+  SDL_Rect source{};
+  source.w = glyph_width;
+  source.h = glyph_height;
+  destination.w = glyph_width;
+  /* Consecutive copies from the same texture are batched by the renderer. */
+  for (const char *c = string; *c != '\0'; c++) {
+    const int character = static_cast<unsigned char>(*c);
+    if (character >= first_character && !is_control_character(character)) {
+      const int i = character - first_character;
+      source.x = (i % columns) * glyph_width;
+      source.y = (i / columns) * glyph_height;
+      SDL_RenderCopy(renderer, texture, &source, &destination);
+    }
+    destination.x += glyph_width;
+  }
+}
@@ -0,0 +1,77 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include "color.hpp"
+#include "integers.hpp"
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <cstring>
+#include <vector>
+
+/**
+ * The glyphs of a monospaced font, rasterized once into a single texture.
+ *
+ * The glyphs are white on a transparent background, so a string of any color is drawn by modulating the texture
+ * color and copying one cell per character. As the font is monospaced, a character is always one cell wide and the
+ * cells are laid out on a grid.
+ *
+ * The alpha of the cells is also kept in memory, so that text can be drawn without a renderer.
+ */
+class GlyphAtlas {
+public:
+  /**
+   * Rasterizes the glyphs of the font. Throws a std::runtime_error if a surface or the texture cannot be created.
+   */
+  GlyphAtlas(TTF_Font *font, int glyph_width, int glyph_height, SDL_Renderer *renderer);
+
+  ~GlyphAtlas();
+
+  GlyphAtlas(const GlyphAtlas &) = delete;
+  GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+  /**
+   * Returns how many pixels wide the provided string is when drawn.
+   */
+  inline int get_width(const char *string) const {
+    return static_cast<int>(strlen(string)) * glyph_width;
+  }
+
+  inline int get_glyph_width() const {
+    return glyph_width;
+  }
+
+  inline int get_height() const {
+    return glyph_height;
+  }
+
+  /**
+   * Draws a string over its background color, with its top left corner at (x, y).
+   *
+   * Characters which are not in the atlas are drawn as blanks.
+   */
+  void draw(int x, int y, const char *string, ColorPair color, SDL_Renderer *renderer) const;
+
+  /**
+   * Returns the coverage of the top left pixel of the cell of a character, or nullptr if it is not in the atlas.
+   *
+   * The rows of a cell are get_coverage_pitch() bytes apart.
+   */
+  const U8 *get_coverage(int character) const;
+
+  inline int get_coverage_pitch() const {
+    return columns * glyph_width;
+  }
+
+private:
+  // The characters in the atlas are the printable ones of Latin-1, which TTF_RenderText uses for strings.
+  static const int first_character = 32;
+  static const int last_character = 255;
+  static const int columns = 16;
+
+  SDL_Texture *texture = nullptr;
+  std::vector<U8> coverage;
+  int glyph_width;
+  int glyph_height;
+};
+
+#endif
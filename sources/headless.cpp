@@ -0,0 +1,177 @@
+#include "game.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
+#include "random.hpp"
+#include "replay.hpp"
+#include "settings.hpp"
+#include "simulation.hpp"
+#include "text.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * The display size only determines the window size computed from the settings, which in turn determines the size of
+ * the tiles and therefore the resolution of the physics.
+ */
+class HeadlessOptions {
+public:
+  U64 ticks = 10000;
+  U32 display_width = 1920;
+  U32 display_height = 1080;
+  InputMode input_mode = INPUT_MODE_RANDOM;
+  U32 input_seed = 1;
+  std::string script;
+  U64 seed = 0;
+  bool revive = false;
+  std::string record;
+  std::string replay;
+  bool real_time = false;
+  U64 stress_platforms = 0;
+  bool fast_forward = false;
+};
+
+static const char *usage = "Usage: walls-of-doom-headless [--ticks N] [--display WIDTH HEIGHT] [--input idle|random] "
+                           "[--input-seed N] [--script FILE] [--seed N] [--revive] [--record FILE]\n"
+                           "       [--stress PLATFORMS] [--fast-forward]\n"
+                           "       walls-of-doom-headless --replay FILE [--real-time]";
+
+static HeadlessOptions parse_options(int argc, char *argv[]) {
+  HeadlessOptions options;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (string_equals(argv[i], "--ticks") && has_value) {
+      options.ticks = string_to_unsigned(argv[++i]);
+    } else if (string_equals(argv[i], "--display") && i + 2 < argc) {
+      options.display_width = static_cast<U32>(string_to_unsigned(argv[++i]));
+      options.display_height = static_cast<U32>(string_to_unsigned(argv[++i]));
+    } else if (string_equals(argv[i], "--input") && has_value) {
+      i++;
+      if (string_equals(argv[i], "idle")) {
+        options.input_mode = INPUT_MODE_IDLE;
+      } else if (string_equals(argv[i], "random")) {
+        options.input_mode = INPUT_MODE_RANDOM;
+      } else {
+        throw std::invalid_argument(std::string("Unknown input mode ") + argv[i] + ".");
+      }
+    } else if (string_equals(argv[i], "--input-seed") && has_value) {
+      options.input_seed = static_cast<U32>(string_to_unsigned(argv[++i]));
+    } else if (string_equals(argv[i], "--script") && has_value) {
+      options.input_mode = INPUT_MODE_SCRIPTED;
+      options.script = argv[++i];
+    } else if (string_equals(argv[i], "--seed") && has_value) {
+      options.seed = string_to_unsigned(argv[++i]);
+    } else if (string_equals(argv[i], "--revive")) {
+      options.revive = true;
+    } else if (string_equals(argv[i], "--record") && has_value) {
+      options.record = argv[++i];
+    } else if (string_equals(argv[i], "--replay") && has_value) {
+      options.replay = argv[++i];
+    } else if (string_equals(argv[i], "--real-time")) {
+      options.real_time = true;
+    } else if (string_equals(argv[i], "--stress") && has_value) {
+      options.stress_platforms = string_to_unsigned(argv[++i]);
+    } else if (string_equals(argv[i], "--fast-forward")) {
+      options.fast_forward = true;
+    } else {
+      throw std::invalid_argument(std::string("Unrecognized argument: ") + argv[i] + ".");
+    }
+  }
+  if (options.stress_platforms > MAXIMUM_PLATFORM_COUNT) {
+    throw std::invalid_argument("Stress worlds have at most " + std::to_string(MAXIMUM_PLATFORM_COUNT) + " platforms.");
+  }
+  if (options.revive && !options.record.empty()) {
+    throw std::invalid_argument("Revived games cannot be recorded, as reviving is not a command.");
+  }
+  if (options.fast_forward && !options.record.empty()) {
+    throw std::invalid_argument("Fast-forwarded games cannot be recorded, as the recording hashes every tick.");
+  }
+  return options;
+}
+
+/**
+ * Sets up a stress world with the provided number of platforms.
+ *
+ * The playfield grows taller than the window until the platforms are as dense as the settings file makes them. The
+ * collider stores lines instead of cells, so its memory grows with the platforms instead of with the playfield.
+ */
+static void configure_stress_world(Settings &settings, const U64 platforms) {
+  const U64 density = std::max(1u, settings.get_platform_count());
+  const U64 lines = std::max<U64>(settings.get_tiles_on_y(), (platforms * settings.get_tiles_on_y() + density - 1) / density);
+  settings.set("PLATFORM_COUNT", std::to_string(platforms).c_str());
+  settings.set("PLAYFIELD_TILES_ON_Y", std::to_string(lines).c_str());
+  settings.set("COLLISION_BACKEND", "LINE_INDEX");
+}
+
+static int play_back(const HeadlessOptions &options) {
+  const Replay replay = Replay::load(options.replay);
+  const PlaybackResult result = play_replay(replay, options.real_time);
+  std::cout << "Replayed " << result.ticks << " of " << replay.get_tick_count() << " ticks in " << double_to_string(result.seconds, 3) << " s";
+  std::cout << " (" << double_to_string(result.ticks / std::max(result.seconds, 1e-9), 0) << " ticks/s)." << '\n';
+  if (result.diverged) {
+    std::cout << "Diverged from the recording on tick " << result.divergent_tick << "." << '\n';
+    return 2;
+  }
+  std::cout << "Matched the recording on every tick." << '\n';
+  return 0;
+}
+
+/**
+ * Runs the game without a window, as fast as possible, and reports how fast the simulation was.
+ *
+ * With --fast-forward, idle ticks on which only the platforms move are skipped, which leaves the game in the same state.
+ *
+ * With --replay, plays a recorded game back instead and reports the first tick where it diverges from the recording.
+ */
+int main(int argc, char *argv[]) {
+  try {
+    const HeadlessOptions options = parse_options(argc, argv);
+    if (!options.replay.empty()) {
+      return play_back(options);
+    }
+    seed_random();
+    Settings settings(settings_filename);
+    if (options.stress_platforms != 0) {
+      configure_stress_world(settings, options.stress_platforms);
+    }
+    settings.compute_window_size(options.display_width, options.display_height);
+    if (options.seed != 0) {
+      settings.set_random_seed(options.seed);
+    }
+    SimulationInput input(options.input_mode, options.input_seed);
+    if (options.input_mode == INPUT_MODE_SCRIPTED) {
+      input = SimulationInput(options.script);
+    }
+    CommandTable table{};
+    initialize_command_table(&table);
+    Player player("Headless", &table);
+    Profiler profiler(true);
+    const auto creation_start = std::chrono::steady_clock::now();
+    Game game(&player, &settings, &profiler, get_game_seed(settings));
+    const std::chrono::duration<double> creation = std::chrono::steady_clock::now() - creation_start;
+    ReplayRecorder recorder(game);
+    const SimulationResult result = run_simulation(&game, input, options.ticks, options.revive, options.record.empty() ? nullptr : &recorder,
+                                                   options.fast_forward);
+    if (!options.record.empty()) {
+      recorder.get_replay().save(options.record);
+    }
+    std::cout << "Ran " << result.ticks << " ticks in " << double_to_string(result.seconds, 3) << " s";
+    std::cout << " (" << double_to_string(result.get_ticks_per_second(), 0) << " ticks/s)." << '\n';
+    std::cout << "Used seed " << game.seed << "." << '\n';
+    std::cout << "Created " << game.platform_count << " platforms on a " << settings.get_playfield_width() << "x" << settings.get_playfield_height();
+    std::cout << " playfield in " << double_to_string(creation.count(), 3) << " s." << '\n';
+    std::cout << "The game state uses " << double_to_string(game.get_memory_usage() / 1048576.0, 2) << " MiB." << '\n';
+    std::cout << "Played " << result.played_frames << " frames and made " << result.score << " points." << '\n';
+    std::cout << '\n' << profiler.dump();
+  } catch (std::invalid_argument &exception) {
+    std::cerr << exception.what() << '\n' << usage << '\n';
+    return 1;
+  } catch (std::exception &exception) {
+    std::cerr << "Exception!" << ' ' << exception.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
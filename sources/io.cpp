@@ -1,24 +1,36 @@
 #include "io.hpp"
 #include "clock.hpp"
 #include "constants.hpp"
+#include "debug_overlay.hpp"
 #include "game.hpp"
+#include "glyph_atlas.hpp"
 #include "joystick.hpp"
 #include "logger.hpp"
 #include "numeric.hpp"
+#include "point.hpp"
 #include "physics.hpp"
 #include "player.hpp"
 #include "profiler.hpp"
 #include "random.hpp"
+#include "rasterizer.hpp"
 #include "record.hpp"
 #include "record_table.hpp"
+#include "render_list.hpp"
+#include "render_snapshot.hpp"
+#include "retained_frame.hpp"
 #include "settings.hpp"
 #include "text.hpp"
+#include "text_cache.hpp"
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
+#include <algorithm>
 #include <cctype>
 #include <cstdio>
 #include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 #define CREATE_SURFACE_FAIL "Failed to create surface in %s!"
 #define CREATE_TEXTURE_FAIL "Failed to create texture in %s!"
@@ -30,6 +42,35 @@
 const char *game_name = "Walls of Doom";
 
 static Font *global_monospaced_font = nullptr;
+static GlyphAtlas *global_glyph_atlas = nullptr;
+static TextCache *global_text_cache = nullptr;
+
+/* Kept between frames, so that recording a frame does not allocate. */
+static RenderList global_render_list;
+
+/* Created when debugging is first turned on. */
+static DebugOverlay *global_debug_overlay = nullptr;
+
+/* Only exists if the renderer supports render targets and the rasterizer is not used. */
+static RetainedFrame *global_retained_frame = nullptr;
+
+/* Only exist if the renderer type is RENDERER_RASTERIZER. The game is drawn into the texture, which is then copied. */
+static Rasterizer *global_rasterizer = nullptr;
+static SDL_Texture *global_rasterizer_texture = nullptr;
+
+/* Only used if the playfield is drawn at a lower resolution and scaled up, into a frame or with a rasterizer. */
+static RenderList global_playfield_list;
+static RetainedFrame *global_playfield_frame = nullptr;
+static Rasterizer *global_playfield_rasterizer = nullptr;
+static SDL_Texture *global_playfield_texture = nullptr;
+static int global_playfield_w = 0;
+static int global_playfield_h = 0;
+
+/* The platforms covering the one being drawn, kept to avoid allocating on every frame. */
+static std::vector<std::pair<int, int>> global_platform_covers;
+
+/* Enough strings for the bars and for any menu, whose textures together take a few megabytes. */
+static const size_t text_cache_capacity = 128;
 
 /* Default integers to one to prevent divisions by zero. */
 static int window_width = 1;
@@ -39,11 +80,15 @@ static int global_monospaced_font_height = 1;
 
 static const int PERK_FADING_INTERVAL = UPS;
 
+/* Whether the last frame presented was drawn by draw_game, so that presenting an identical frame can be skipped. */
+static bool global_game_on_screen = false;
+
 /**
  * Clears the screen.
  */
 void clear(Renderer *renderer) {
   SDL_RenderClear(renderer);
+  global_game_on_screen = false;
 }
 
 /**
@@ -65,18 +110,6 @@ int get_font_height() {
   return global_monospaced_font_height;
 }
 
-/**
- * Swap the renderer color by the provided color.
- *
- * The color previously in the renderer will be copied to the pointer.
- */
-static void swap_color(Renderer *renderer, SDL_Color *color) {
-  SDL_Color swap{};
-  SDL_GetRenderDrawColor(renderer, &swap.r, &swap.g, &swap.b, &swap.a);
-  SDL_SetRenderDrawColor(renderer, color->r, color->g, color->b, color->a);
-  *color = swap;
-}
-
 /**
  * Initializes the global fonts.
  */
@@ -116,6 +149,86 @@ static Code initialize_font_metrics() {
   return CODE_OK;
 }
 
+/**
+ * Rasterizes the glyphs of the global font, so that printing text does not render any.
+ */
+static Code initialize_glyph_atlas(Renderer *renderer) {
+  if (global_glyph_atlas != nullptr) {
+    return CODE_OK;
+  }
+  try {
+    global_glyph_atlas = new GlyphAtlas(global_monospaced_font, global_monospaced_font_width, global_monospaced_font_height, renderer);
+  } catch (std::runtime_error &error) {
+    log_message(error.what());
+    return CODE_ERROR;
+  }
+  /* Without render targets, strings are drawn from the atlas every time. */
+  if (SDL_RenderTargetSupported(renderer) == SDL_TRUE) {
+    global_text_cache = new TextCache(text_cache_capacity, global_glyph_atlas);
+  } else {
+    log_message("The renderer does not support render targets, so text is not cached.");
+  }
+  return CODE_OK;
+}
+
+/**
+ * Prepares drawing the playfield with fewer pixels per tile than the window has, if the settings ask for it.
+ */
+static void initialize_playfield_upscaling(const Settings &settings, Renderer *renderer) {
+  const U32 pixels_per_tile = settings.get_playfield_pixels_per_tile();
+  if (pixels_per_tile == 0 || (pixels_per_tile >= settings.get_tile_w() && pixels_per_tile >= settings.get_tile_h())) {
+    return;
+  }
+  global_playfield_w = static_cast<int>(settings.get_tiles_on_x() * pixels_per_tile);
+  global_playfield_h = static_cast<int>(settings.get_tiles_on_y() * pixels_per_tile);
+  /* Scaling up must keep the edges of the tiles sharp. */
+  SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+  if (global_rasterizer != nullptr) {
+    global_playfield_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, global_playfield_w, global_playfield_h);
+    if (global_playfield_texture != nullptr) {
+      /* The playfield is so small that a thread would cost more than it saves. */
+      global_playfield_rasterizer = new Rasterizer(global_playfield_w, global_playfield_h, 1, nullptr);
+    }
+  } else if (SDL_RenderTargetSupported(renderer) == SDL_TRUE) {
+    global_playfield_frame = new RetainedFrame();
+  }
+  if (global_playfield_rasterizer == nullptr && global_playfield_frame == nullptr) {
+    log_message("Could not create a texture for the playfield, so it is drawn at the resolution of the window.");
+    return;
+  }
+  log_message("Drawing the playfield at " + std::to_string(global_playfield_w) + "x" + std::to_string(global_playfield_h) + ".");
+}
+
+static bool is_upscaling_playfield() {
+  return global_playfield_frame != nullptr || global_playfield_rasterizer != nullptr;
+}
+
+/**
+ * Chooses how the game is drawn: by the rasterizer, into a retained frame, or straight to the screen.
+ */
+static void initialize_frame_drawing(const Settings &settings, Renderer *renderer) {
+  const int w = settings.get_window_width();
+  const int h = settings.get_window_height();
+  if (settings.get_renderer_type() == RENDERER_RASTERIZER) {
+    global_rasterizer_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+    if (global_rasterizer_texture != nullptr) {
+      const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+      global_rasterizer = new Rasterizer(w, h, threads, global_glyph_atlas);
+      log_message("Drawing the game with " + std::to_string(global_rasterizer->get_band_count()) + " rasterizer threads.");
+    } else {
+      log_message("Failed to create the rasterizer texture, so the renderer draws the game.");
+    }
+  }
+  if (global_rasterizer == nullptr) {
+    if (SDL_RenderTargetSupported(renderer) == SDL_TRUE) {
+      global_retained_frame = new RetainedFrame();
+    } else {
+      log_message("The renderer does not support render targets, so every frame is drawn whole.");
+    }
+  }
+  initialize_playfield_upscaling(settings, renderer);
+}
+
 static Window *create_window(const Settings &settings, int *width, int *height) {
   const int x = SDL_WINDOWPOS_CENTERED;
   const int y = SDL_WINDOWPOS_CENTERED;
@@ -199,10 +312,19 @@ Code initialize(Settings &settings, Window **window, Renderer **renderer) {
   set_window_title_and_icon(*window);
   if (settings.get_renderer_type() == RENDERER_HARDWARE) {
     renderer_flags = SDL_RENDERER_ACCELERATED;
-  } else {
+  } else if (settings.get_renderer_type() == RENDERER_SOFTWARE) {
     renderer_flags = SDL_RENDERER_SOFTWARE;
+  } else {
+    /* The renderer only copies the frames of the rasterizer and draws the menus, so let SDL pick any. */
+    renderer_flags = 0;
   }
   *renderer = SDL_CreateRenderer(*window, -1, renderer_flags);
+  if (initialize_glyph_atlas(*renderer) != 0u) {
+    sprintf(log_buffer, "Failed to initialize the glyph atlas.");
+    log_message(log_buffer);
+    return CODE_ERROR;
+  }
+  initialize_frame_drawing(settings, *renderer);
   set_color(*renderer, COLOR_DEFAULT_BACKGROUND);
   clear(*renderer);
   return CODE_OK;
@@ -212,6 +334,13 @@ Code initialize(Settings &settings, Window **window, Renderer **renderer) {
  * Finalizes the global fonts.
  */
 static void finalize_fonts() {
+  if (global_text_cache != nullptr) {
+    log_message("The text cache had " + std::to_string(global_text_cache->get_hits()) + " hits and " + std::to_string(global_text_cache->get_misses()) + " misses.");
+  }
+  delete global_text_cache;
+  global_text_cache = nullptr;
+  delete global_glyph_atlas;
+  global_glyph_atlas = nullptr;
   if (global_monospaced_font != nullptr) {
     TTF_CloseFont(global_monospaced_font);
     global_monospaced_font = nullptr;
@@ -224,6 +353,24 @@ static void finalize_fonts() {
  * Should only be called once, right before exiting.
  */
 Code finalize(Window **window, Renderer **renderer) {
+  delete global_debug_overlay;
+  global_debug_overlay = nullptr;
+  delete global_retained_frame;
+  global_retained_frame = nullptr;
+  delete global_rasterizer;
+  global_rasterizer = nullptr;
+  if (global_rasterizer_texture != nullptr) {
+    SDL_DestroyTexture(global_rasterizer_texture);
+    global_rasterizer_texture = nullptr;
+  }
+  delete global_playfield_frame;
+  global_playfield_frame = nullptr;
+  delete global_playfield_rasterizer;
+  global_playfield_rasterizer = nullptr;
+  if (global_playfield_texture != nullptr) {
+    SDL_DestroyTexture(global_playfield_texture);
+    global_playfield_texture = nullptr;
+  }
   finalize_fonts();
   finalize_joystick();
   SDL_DestroyRenderer(*renderer);
@@ -239,14 +386,18 @@ Code finalize(Window **window, Renderer **renderer) {
   return CODE_OK;
 }
 
+/**
+ * Draws a string through the text cache, if there is one, or straight from the glyph atlas.
+ */
+static void draw_text(const int x, const int y, const char *string, const ColorPair color, Renderer *renderer) {
+  if (global_text_cache != nullptr) {
+    global_text_cache->draw(x, y, string, color, renderer);
+  } else {
+    global_glyph_atlas->draw(x, y, string, color, renderer);
+  }
+}
+
 Code print_absolute(const int x, const int y, const char *string, const ColorPair color, Renderer *renderer) {
-  char log_buffer[MAXIMUM_STRING_SIZE];
-  Font *font = global_monospaced_font;
-  SDL_Surface *surface;
-  SDL_Texture *texture;
-  SDL_Rect position{};
-  position.x = x;
-  position.y = y;
   if (string == nullptr || string[0] == '\0') {
     return CODE_OK;
   }
@@ -254,25 +405,7 @@ Code print_absolute(const int x, const int y, const char *string, const ColorPai
   if (x < 0 || y < 0) {
     return CODE_ERROR;
   }
-  auto foreground_color = color.foreground.to_SDL_color();
-  auto background_color = color.background.to_SDL_color();
-  surface = TTF_RenderText_Shaded(font, string, foreground_color, background_color);
-  if (surface == nullptr) {
-    sprintf(log_buffer, CREATE_SURFACE_FAIL, "print_absolute()");
-    log_message(log_buffer);
-    return CODE_ERROR;
-  }
-  texture = SDL_CreateTextureFromSurface(renderer, surface);
-  if (texture == nullptr) {
-    sprintf(log_buffer, CREATE_TEXTURE_FAIL, "print_absolute()");
-    log_message(log_buffer);
-    return CODE_ERROR;
-  }
-  /* Copy destination width and height from the texture. */
-  SDL_QueryTexture(texture, nullptr, nullptr, &position.w, &position.h);
-  SDL_RenderCopy(renderer, texture, nullptr, &position);
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(surface);
+  draw_text(x, y, string, color, renderer);
   return CODE_OK;
 }
 
@@ -341,16 +474,7 @@ void print_long_text(const Settings &settings, char *string, Renderer *renderer)
  * Prints the provided strings centered at the specified absolute line.
  */
 static Code print_centered_horizontally(const Settings &settings, const std::vector<std::string> &strings, const ColorPair color, Renderer *renderer, const int y) {
-  char log_buffer[MAXIMUM_STRING_SIZE];
-  const SDL_Color foreground = color.foreground.to_SDL_color();
-  const SDL_Color background = color.background.to_SDL_color();
-  const auto slice_size = settings.get_window_width() / strings.size();
-  Font *font = global_monospaced_font;
-  SDL_Surface *surface;
-  SDL_Texture *texture;
-  SDL_Rect position{};
-  position.x = 0;
-  position.y = y;
+  const auto slice_size = static_cast<int>(settings.get_window_width() / strings.size());
   /* Validate that x and y are nonnegative. */
   if (y < 0) {
     return CODE_ERROR;
@@ -359,24 +483,8 @@ static Code print_centered_horizontally(const Settings &settings, const std::vec
     if (strings[i].empty()) {
       continue;
     }
-    surface = TTF_RenderText_Shaded(font, strings[i].c_str(), foreground, background);
-    if (surface == nullptr) {
-      sprintf(log_buffer, CREATE_SURFACE_FAIL, "print_centered_horizontally()");
-      log_message(log_buffer);
-      return CODE_ERROR;
-    }
-    texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == nullptr) {
-      sprintf(log_buffer, CREATE_TEXTURE_FAIL, "print_centered_horizontally()");
-      log_message(log_buffer);
-      return CODE_ERROR;
-    }
-    /* Copy destination width and height from the texture. */
-    SDL_QueryTexture(texture, nullptr, nullptr, &position.w, &position.h);
-    position.x = i * slice_size + (slice_size - position.w) / 2;
-    SDL_RenderCopy(renderer, texture, nullptr, &position);
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
+    const int x = i * slice_size + (slice_size - global_glyph_atlas->get_width(strings[i].c_str())) / 2;
+    draw_text(x, y, strings[i].c_str(), color, renderer);
   }
   return CODE_OK;
 }
@@ -444,121 +552,137 @@ void print_menu(const Settings &settings, const std::vector<std::string> &lines,
   present(renderer);
 }
 
-/**
- * Draws an absolute rectangle based on the provided coordinates.
- */
-static void draw_absolute_rectangle(int x, int y, int w, int h, Color color, Renderer *renderer) {
-  SDL_Color swap = color.to_SDL_color();
-  SDL_Rect rectangle{};
-  rectangle.x = x;
-  rectangle.y = y;
-  rectangle.w = w;
-  rectangle.h = h;
-  swap_color(renderer, &swap);
-  SDL_RenderFillRect(renderer, &rectangle);
-  swap_color(renderer, &swap);
-}
-
-/**
- * Draws a shaded absolute rectangle based on the provided coordinates.
- */
-static void draw_shaded_absolute_rectangle(int x, int y, int w, int h, Color color, Renderer *renderer) {
-  SDL_Color swap = color.to_SDL_color();
-  SDL_Rect rectangle{};
-  rectangle.x = x;
-  rectangle.y = y;
-  rectangle.w = w;
-  rectangle.h = h;
-  swap_color(renderer, &swap);
-  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-  SDL_RenderFillRect(renderer, &rectangle);
-  swap_color(renderer, &swap);
-}
-
-static void draw_absolute_tile_rectangle(const Settings &settings, int x, int y, Color color, Renderer *renderer) {
+static void add_tile_rectangle(const Settings &settings, RenderLayer layer, int x, int y, Color color, RenderList *list) {
   const int w = settings.get_tile_w();
   const int h = settings.get_tile_h();
   y += settings.get_bar_height();
-  draw_absolute_rectangle(x, y, w, h, color, renderer);
+  list->add_rectangle(layer, x, y, w, h, color);
 }
 
-static void draw_shaded_absolute_tile_rectangle(const Settings &settings, int x, int y, Color color, Renderer *renderer) {
+static void add_shaded_tile_rectangle(const Settings &settings, RenderLayer layer, int x, int y, Color color, RenderList *list) {
   const int w = settings.get_tile_w();
   const int h = settings.get_tile_h();
   y += settings.get_bar_height();
-  draw_shaded_absolute_rectangle(x, y, w, h, color, renderer);
+  list->add_blended_rectangle(layer, x, y, w, h, color);
 }
 
-static void write_top_bar_strings(const Settings &settings, const std::vector<std::string> &strings, Renderer *renderer) {
+static void write_top_bar_strings(const Settings &settings, const std::vector<std::string> &strings, RenderList *list) {
   const ColorPair color_pair = COLOR_PAIR_TOP_BAR;
   const int y = (settings.get_bar_height() - get_font_height()) / 2;
   int h = settings.get_bar_height();
   int w = settings.get_window_width();
-  draw_absolute_rectangle(0, 0, w, h, color_pair.background, renderer);
-  print_centered_horizontally(settings, strings, color_pair, renderer, y);
+  list->add_rectangle(RENDER_LAYER_BARS, 0, 0, w, h, color_pair.background);
+  const auto slice_size = static_cast<int>(settings.get_window_width() / strings.size());
+  for (int i = 0; i < static_cast<int>(strings.size()); i++) {
+    if (strings[i].empty()) {
+      continue;
+    }
+    const int text_width = global_glyph_atlas->get_width(strings[i].c_str());
+    const int x = i * slice_size + (slice_size - text_width) / 2;
+    list->add_text(RENDER_LAYER_BARS, x, y, text_width, global_glyph_atlas->get_height(), strings[i], color_pair);
+  }
 }
 
 /**
  * Draws the top status bar on the screen for a given Player.
  */
-static void draw_top_bar(const Settings &settings, const Game *game, Renderer *renderer) {
-  const Player *player = game->player;
+static void draw_top_bar(const Settings &settings, const RenderSnapshot &snapshot, RenderList *list) {
   std::vector<std::string> strings;
   std::string perk_name = "No Power";
-  if (player->perk != PERK_NONE) {
-    perk_name = get_perk_name(player->perk);
+  if (snapshot.player_perk != PERK_NONE) {
+    perk_name = get_perk_name(snapshot.player_perk);
   }
-  const auto limit = game->limit_played_frames;
-  const auto time_left = (limit - game->played_frames) / static_cast<double>(UPS);
+  const auto limit = snapshot.limit_played_frames;
+  const auto time_left = (limit - snapshot.played_frames) / static_cast<double>(UPS);
   strings.push_back(double_to_string(time_left, 2));
   strings.push_back(perk_name);
-  strings.push_back("Lives: " + std::to_string(player->lives));
-  strings.push_back("Score: " + std::to_string(player->score));
-  write_top_bar_strings(settings, strings, renderer);
+  strings.push_back("Lives: " + std::to_string(snapshot.lives));
+  strings.push_back("Score: " + std::to_string(snapshot.score));
+  write_top_bar_strings(settings, strings, list);
 }
 
-static void write_bottom_bar_string(const Settings &settings, const char *string, Renderer *renderer) {
+static void write_bottom_bar_string(const Settings &settings, const std::string &string, RenderList *list) {
   /* Use half a character for horizontal padding. */
   const int x = get_font_width() / 2;
   const int bar_start = settings.get_window_height() - settings.get_bar_height();
   const int padding = (settings.get_bar_height() - get_font_height()) / 2;
   const int y = bar_start + padding;
-  print_absolute(x, y, string, COLOR_PAIR_BOTTOM_BAR, renderer);
+  if (!string.empty()) {
+    const int w = global_glyph_atlas->get_width(string.c_str());
+    list->add_text(RENDER_LAYER_BARS, x, y, w, global_glyph_atlas->get_height(), string, COLOR_PAIR_BOTTOM_BAR);
+  }
 }
 
 /*
  * Draws the bottom status bar on the screen for a given Player.
  */
-static void draw_bottom_bar(const Settings &settings, const char *message, Renderer *renderer) {
+static void draw_bottom_bar(const Settings &settings, const std::string &message, RenderList *list) {
   const Color color = COLOR_PAIR_BOTTOM_BAR.background;
   const int y = settings.get_window_height() - settings.get_bar_height();
   const int w = settings.get_window_width();
   const int h = settings.get_bar_height();
-  draw_absolute_rectangle(0, y, w, h, color, renderer);
-  write_bottom_bar_string(settings, message, renderer);
+  list->add_rectangle(RENDER_LAYER_BARS, 0, y, w, h, color);
+  write_bottom_bar_string(settings, message, list);
 }
 
-static Color get_platform_color(Platform platform) {
-  return COLOR_PAIR_PLATFORM_A.foreground.mix(COLOR_PAIR_PLATFORM_B.foreground, platform.rarity);
+static Color get_platform_color(const float rarity) {
+  return COLOR_PAIR_PLATFORM_A.foreground.mix(COLOR_PAIR_PLATFORM_B.foreground, rarity);
 }
 
-static void draw_platforms(const Settings &settings, const std::vector<Platform> &platforms, BoundingBox box, Renderer *renderer) {
+/**
+ * Draws the parts of the platforms from begin to end, which are on the same line, that no platform with a larger index
+ * covers.
+ *
+ * Platforms which overlap are seen as if they were drawn in index order. The render list reorders the shapes of a layer
+ * by color, so the parts which a later platform covers are left out instead of drawn over.
+ */
+static void draw_platform_line(const Settings &settings, const RenderSnapshot &snapshot, const size_t begin, const size_t end, std::vector<std::pair<int, int>> &covers, RenderList *list) {
   const auto y_padding = settings.get_bar_height();
-  for (const auto &platform : platforms) {
-    auto p = platform;
-    auto x = std::max(box.min_x, p.x);
-    auto y = y_padding + p.y;
-    auto w = std::min(box.max_x, p.x + p.w - 1) - x + 1;
-    auto h = p.h;
-    draw_absolute_rectangle(x, y, w, h, get_platform_color(platform), renderer);
+  const Point origin = snapshot.origin;
+  const int view_end = origin.x + snapshot.view_width;
+  for (size_t i = begin; i < end; i++) {
+    const Platform &platform = snapshot.platforms[i];
+    auto x = std::max(origin.x, platform.x);
+    const auto platform_end = std::min(view_end, platform.x + platform.w);
+    covers.clear();
+    for (size_t j = begin; j < end; j++) {
+      const Platform &other = snapshot.platforms[j];
+      if (snapshot.platform_indices[j] > snapshot.platform_indices[i] && other.x < platform_end && other.x + other.w > x) {
+        covers.emplace_back(other.x, other.x + other.w);
+      }
+    }
+    std::sort(covers.begin(), covers.end());
+    const auto y = y_padding + platform.y - origin.y;
+    const Color color = get_platform_color(platform.rarity);
+    for (const auto &cover : covers) {
+      if (cover.first > x) {
+        list->add_rectangle(RENDER_LAYER_PLATFORMS, x - origin.x, y, cover.first - x, platform.h, color);
+      }
+      x = std::max(x, cover.second);
+    }
+    if (x < platform_end) {
+      list->add_rectangle(RENDER_LAYER_PLATFORMS, x - origin.x, y, platform_end - x, platform.h, color);
+    }
   }
 }
 
-static int has_active_perk(const Game *const game) {
-  return static_cast<int>(game->perk != PERK_NONE);
+/**
+ * Draws the platforms in view, cut to the view.
+ */
+static void draw_platforms(const Settings &settings, const RenderSnapshot &snapshot, RenderList *list) {
+  /* The platforms of a line are next to each other, and only platforms of the same line can overlap. */
+  size_t begin = 0;
+  while (begin < snapshot.platforms.size()) {
+    size_t end = begin + 1;
+    while (end < snapshot.platforms.size() && snapshot.platforms[end].y == snapshot.platforms[begin].y) {
+      end++;
+    }
+    draw_platform_line(settings, snapshot, begin, end, global_platform_covers, list);
+    begin = end;
+  }
 }
 
-static void draw_resized_perk(int x, int y, int w, int h, double f, Renderer *renderer) {
+static void draw_resized_perk(int x, int y, int w, int h, double f, RenderList *list) {
   /* The scaled values. */
   const auto s_w = static_cast<int>(f * w);
   const auto s_h = static_cast<int>(f * h);
@@ -588,48 +712,100 @@ static void draw_resized_perk(int x, int y, int w, int h, double f, Renderer *re
   f_y = y + (h - f_h) / 2;
   b_x = x + (w - b_w) / 2;
   b_y = y + (h - b_h) / 2;
-  draw_absolute_rectangle(b_x, b_y, b_w, b_h, b_color, renderer);
-  draw_absolute_rectangle(f_x, f_y, f_w, f_h, f_color, renderer);
+  list->add_rectangle(RENDER_LAYER_PERK_BACKGROUND, b_x, b_y, b_w, b_h, b_color);
+  list->add_rectangle(RENDER_LAYER_PERK, f_x, f_y, f_w, f_h, f_color);
 }
 
-static void draw_active_perk(const Settings &settings, const Game *const game, Renderer *renderer) {
+static void draw_active_perk(const Settings &settings, const RenderSnapshot &snapshot, RenderList *list) {
   const int interval = PERK_FADING_INTERVAL;
   const int y_padding = settings.get_bar_height();
-  const auto remaining = static_cast<int>(game->perk_end_frame - game->played_frames);
+  const auto remaining = static_cast<int>(snapshot.perk_end_frame - snapshot.played_frames);
   const double fraction = std::min(interval, remaining) / static_cast<double>(interval);
-  const int x = game->perk_x;
-  const int y = y_padding + game->perk_y;
-  draw_resized_perk(x, y, game->tile_w, game->tile_h, fraction, renderer);
+  const int x = snapshot.perk_x - snapshot.origin.x;
+  const int y = y_padding + snapshot.perk_y - snapshot.origin.y;
+  draw_resized_perk(x, y, settings.get_tile_w(), settings.get_tile_h(), fraction, list);
 }
 
-static void draw_perk(const Settings &settings, const Game *const game, Renderer *renderer) {
-  if (has_active_perk(game) != 0) {
-    draw_active_perk(settings, game, renderer);
+static void draw_perk(const Settings &settings, const RenderSnapshot &snapshot, RenderList *list) {
+  if (snapshot.perk != PERK_NONE) {
+    draw_active_perk(settings, snapshot, list);
   }
 }
 
-Code draw_player(const Settings &settings, const Player *const player, Renderer *renderer) {
-  draw_absolute_tile_rectangle(settings, player->x, player->y, COLOR_PAIR_PLAYER.foreground, renderer);
-  const auto points = static_cast<double>(player->graphics.get_maximum_size());
+static void draw_player(const Settings &settings, const RenderSnapshot &snapshot, RenderList *list) {
+  const Point origin = snapshot.origin;
+  add_tile_rectangle(settings, RENDER_LAYER_PLAYER, snapshot.player.x - origin.x, snapshot.player.y - origin.y, COLOR_PAIR_PLAYER.foreground, list);
+  const auto points = static_cast<double>(snapshot.trail_size);
   size_t i = 0;
-  for (const auto point : player->graphics.trail) {
+  for (const auto point : snapshot.trail) {
     auto color = COLOR_PAIR_PLAYER.foreground;
     color.a = static_cast<U8>((i + 1) * (std::numeric_limits<U8>::max() / points));
-    draw_shaded_absolute_tile_rectangle(settings, point.x, point.y, color, renderer);
+    add_shaded_tile_rectangle(settings, RENDER_LAYER_TRAIL, point.x - origin.x, point.y - origin.y, color, list);
     i++;
   }
+}
+
+/**
+ * Draws the occupied pixels of the view over everything else, uploading only the rows which changed.
+ */
+static void draw_debugging(const Settings &settings, const RenderSnapshot &snapshot, Profiler *profiler, Renderer *renderer) {
+  if (global_debug_overlay == nullptr) {
+    global_debug_overlay = new DebugOverlay();
+  }
+  profiler->count("uploaded_rows", global_debug_overlay->update(snapshot, renderer));
+  global_debug_overlay->draw(0, settings.get_bar_height(), renderer);
+}
+
+static void count_render_list_statistics(const RenderListStatistics &statistics, Profiler *profiler) {
+  profiler->count("rectangles", statistics.rectangles);
+  profiler->count("texts", statistics.texts);
+  profiler->count("draw_calls", statistics.draw_calls);
+}
+
+/**
+ * Draws the frame with a rasterizer into its texture and copies the texture to the destination, or to the whole
+ * screen if the destination is nullptr.
+ */
+static Code draw_rasterized(RenderList *list, Rasterizer *rasterizer, SDL_Texture *texture, const SDL_Rect *destination, Profiler *profiler, Renderer *renderer) {
+  void *pixels = nullptr;
+  int pitch = 0;
+  if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0) {
+    return CODE_ERROR;
+  }
+  profiler->start("rasterize");
+  /* The texture may move between locks, so the target is set every time. */
+  rasterizer->set_target(pixels, pitch);
+  count_render_list_statistics(list->submit(*rasterizer, COLOR_DEFAULT_BACKGROUND), profiler);
+  SDL_UnlockTexture(texture);
+  profiler->stop();
+  profiler->start("copy_rasterized_frame");
+  SDL_RenderCopy(renderer, texture, nullptr, destination);
+  profiler->stop();
   return CODE_OK;
 }
 
-static void draw_debugging(const Settings &settings, Game *const game, Renderer *renderer) {
-  const auto height = settings.get_bar_height();
-  const Color color(255, 255, 255, 127);
-  for (int x = game->box.min_x; x <= game->box.max_x; x++) {
-    for (int y = game->box.min_y; y <= game->box.max_y; y++) {
-      if (get_from_rigid_matrix(game, x, y) != 0u) {
-        draw_absolute_rectangle(x, height + y, 1, 1, color, renderer);
-      }
-    }
+/**
+ * Returns the part of the window where the playfield is drawn.
+ */
+static SDL_Rect get_playfield_rectangle(const Settings &settings) {
+  SDL_Rect rectangle{};
+  rectangle.y = settings.get_bar_height();
+  rectangle.w = get_view_width(settings);
+  rectangle.h = get_view_height(settings);
+  return rectangle;
+}
+
+/**
+ * Scales the low resolution playfield up to its part of the window.
+ */
+static void draw_upscaled_playfield(const Settings &settings, RenderList *playfield, Profiler *profiler, Renderer *renderer) {
+  const SDL_Rect destination = get_playfield_rectangle(settings);
+  if (global_playfield_rasterizer != nullptr) {
+    draw_rasterized(playfield, global_playfield_rasterizer, global_playfield_texture, &destination, profiler, renderer);
+  } else if (global_playfield_frame != nullptr) {
+    profiler->start("copy_playfield_frame");
+    global_playfield_frame->copy(renderer, &destination);
+    profiler->stop();
   }
 }
 
@@ -638,44 +814,104 @@ static void draw_debugging(const Settings &settings, Game *const game, Renderer
  *
  * Returns a Milliseconds approximation of the time this function took.
  */
-Milliseconds draw_game(Game *const game, Renderer *renderer) {
+Milliseconds draw_game(const Settings &settings, const RenderSnapshot &snapshot, Profiler *profiler, Renderer *renderer) {
   Milliseconds draw_game_start = get_milliseconds();
-  const auto &settings = *game->settings;
-  game->profiler->start("draw_game");
+  const U64 text_cache_hits = global_text_cache != nullptr ? global_text_cache->get_hits() : 0;
+  const U64 text_cache_misses = global_text_cache != nullptr ? global_text_cache->get_misses() : 0;
+  profiler->start("draw_game");
 
-  game->profiler->start("clear");
-  clear(renderer);
-  game->profiler->stop();
-
-  game->profiler->start("draw_top_bar");
-  draw_top_bar(settings, game, renderer);
-  game->profiler->stop();
+  profiler->start("record");
+  RenderList *list = &global_render_list;
+  list->clear();
+  draw_top_bar(settings, snapshot, list);
+  draw_bottom_bar(settings, snapshot.message, list);
+  /* The bars stay at the resolution of the window, so that their text is sharp. */
+  RenderList *playfield = list;
+  if (is_upscaling_playfield()) {
+    playfield = &global_playfield_list;
+    playfield->clear();
+  }
+  draw_platforms(settings, snapshot, playfield);
+  draw_perk(settings, snapshot, playfield);
+  draw_player(settings, snapshot, playfield);
+  if (playfield != list) {
+    playfield->scale_to(get_playfield_rectangle(settings), global_playfield_w, global_playfield_h);
+  }
+  profiler->stop();
 
-  game->profiler->start("draw_bottom_bar");
-  draw_bottom_bar(settings, game->message, renderer);
-  game->profiler->stop();
+  /* Only if every part of the frame is retained can an unchanged frame be skipped. */
+  bool unchanged = global_retained_frame != nullptr;
+  if (global_retained_frame != nullptr) {
+    profiler->start("update_retained_frame");
+    const int w = settings.get_window_width();
+    const int h = settings.get_window_height();
+    unchanged = !global_retained_frame->update(*list, w, h, COLOR_DEFAULT_BACKGROUND, renderer, draw_text);
+    count_render_list_statistics(global_retained_frame->get_statistics(), profiler);
+    profiler->count("dirty_rectangles", global_retained_frame->get_dirty_rectangles());
+    profiler->stop();
+    if (!global_retained_frame->has_texture()) {
+      log_message("Failed to create the retained frame, so every frame is drawn whole.");
+      delete global_retained_frame;
+      global_retained_frame = nullptr;
+    }
+  }
+  if (global_playfield_frame != nullptr) {
+    profiler->start("update_playfield_frame");
+    const bool changed = global_playfield_frame->update(*playfield, global_playfield_w, global_playfield_h, COLOR_DEFAULT_BACKGROUND, renderer, draw_text);
+    count_render_list_statistics(global_playfield_frame->get_statistics(), profiler);
+    profiler->stop();
+    unchanged = unchanged && !changed;
+    if (!global_playfield_frame->has_texture()) {
+      log_message("Failed to create the playfield frame, so it is not scaled up anymore.");
+      delete global_playfield_frame;
+      global_playfield_frame = nullptr;
+    }
+  }
+  if (unchanged && global_retained_frame != nullptr && !snapshot.debugging && global_game_on_screen) {
+    /* What is on the screen is still right. */
+    profiler->count("skipped_frames", 1);
+    profiler->stop();
+    return get_milliseconds() - draw_game_start;
+  }
 
-  game->profiler->start("draw_platforms");
-  draw_platforms(settings, game->platforms, game->box, renderer);
-  game->profiler->stop();
+  const bool rasterized = global_rasterizer != nullptr && draw_rasterized(list, global_rasterizer, global_rasterizer_texture, nullptr, profiler, renderer) == CODE_OK;
+  if (rasterized) {
+    profiler->count("rasterized_frames", 1);
+  } else if (global_retained_frame != nullptr) {
+    profiler->start("copy_retained_frame");
+    global_retained_frame->copy(renderer, nullptr);
+    profiler->stop();
+  } else {
+    profiler->start("clear");
+    clear(renderer);
+    profiler->stop();
 
-  game->profiler->start("draw_perk");
-  draw_perk(settings, game, renderer);
-  game->profiler->stop();
+    profiler->start("submit");
+    count_render_list_statistics(list->submit(renderer, draw_text), profiler);
+    profiler->stop();
+  }
 
-  game->profiler->start("draw_player");
-  draw_player(settings, game->player, renderer);
-  game->profiler->stop();
+  if (playfield != list) {
+    draw_upscaled_playfield(settings, playfield, profiler, renderer);
+  }
 
-  if (game->debugging) {
-    draw_debugging(settings, game, renderer);
+  if (snapshot.debugging) {
+    profiler->start("draw_debugging");
+    draw_debugging(settings, snapshot, profiler, renderer);
+    profiler->stop();
   }
 
-  game->profiler->start("present");
+  profiler->start("present");
   present(renderer);
-  game->profiler->stop();
+  global_game_on_screen = true;
+  profiler->stop();
+
+  if (global_text_cache != nullptr) {
+    profiler->count("text_cache_hits", global_text_cache->get_hits() - text_cache_hits);
+    profiler->count("text_cache_misses", global_text_cache->get_misses() - text_cache_misses);
+  }
 
-  game->profiler->stop();
+  profiler->stop();
   return get_milliseconds() - draw_game_start;
 }
 
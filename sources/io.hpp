@@ -9,6 +9,7 @@
 #include "perk.hpp"
 #include "physics.hpp"
 #include "record.hpp"
+#include "render_snapshot.hpp"
 #include <SDL_ttf.h>
 #include <string>
 #include <vector>
@@ -72,7 +73,7 @@ Code read_player_name(const Settings &settings, std::string &destination, Render
  *
  * Returns a Milliseconds approximation of the time this function took.
  */
-Milliseconds draw_game(Game *game, Renderer *renderer);
+Milliseconds draw_game(const Settings &settings, const RenderSnapshot &snapshot, Profiler *profiler, Renderer *renderer);
 
 Code top_scores(const Settings &settings, Profiler &profiler, Renderer *renderer, CommandTable *table);
 
@@ -0,0 +1,224 @@
+#include "line_index.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+static const int UNLIMITED = std::numeric_limits<int>::max();
+
+typedef std::map<int, U8> Steps;
+
+static int get_count_at(const Steps &steps, const int x) {
+  auto next = steps.upper_bound(x);
+  if (next == steps.begin()) {
+    return 0;
+  }
+  return (--next)->second;
+}
+
+/**
+ * Makes sure there is a step starting at x, so that the counts from x onwards can be changed independently.
+ */
+static void split_at(Steps &steps, const int x) {
+  if (steps.find(x) == steps.end()) {
+    steps.emplace(x, static_cast<U8>(get_count_at(steps, x)));
+  }
+}
+
+/**
+ * Removes the step starting at x if it has the same count as the step before it.
+ */
+static void merge_at(Steps &steps, const int x) {
+  const auto step = steps.find(x);
+  if (step == steps.end()) {
+    return;
+  }
+  const int previous = step == steps.begin() ? 0 : std::prev(step)->second;
+  if (step->second == previous) {
+    steps.erase(step);
+  }
+}
+
+LineIndex::LineIndex(BoundingBox box, int line_height) : box(box), line_height(line_height) {
+  lines.resize(static_cast<size_t>((box.max_y - box.min_y + 1) / line_height));
+}
+
+/**
+ * Returns the line which contains the row y, or -1 if it is not in any line.
+ */
+int LineIndex::get_line(const int y) const {
+  if (y < box.min_y || y > box.max_y) {
+    return -1;
+  }
+  const int line = (y - box.min_y) / line_height;
+  if (line >= static_cast<int>(lines.size())) {
+    return -1;
+  }
+  return line;
+}
+
+int LineIndex::get_line_start(const int line) const {
+  return box.min_y + line * line_height;
+}
+
+bool LineIndex::is_line_free(const int line, const int x, const int w) const {
+  const int min_x = std::max(x, box.min_x);
+  const int max_x = std::min(x + w - 1, box.max_x);
+  if (min_x > max_x) {
+    return true;
+  }
+  const Steps &steps = lines[line];
+  const auto next = steps.upper_bound(min_x);
+  if (next != steps.begin() && std::prev(next)->second != 0) {
+    return false;
+  }
+  /* Adjacent steps never have the same count, so any step after a free one is occupied. */
+  return next == steps.end() || next->first > max_x;
+}
+
+/**
+ * Counts the free columns of a line starting at x, without a limit.
+ */
+int LineIndex::count_free_line_columns(const int line, const int x, const int direction) const {
+  const Steps &steps = lines[line];
+  const auto next = steps.upper_bound(x);
+  if (next != steps.begin() && std::prev(next)->second != 0) {
+    return 0;
+  }
+  if (direction > 0) {
+    return next == steps.end() ? UNLIMITED : next->first - x;
+  }
+  return next == steps.begin() ? UNLIMITED : x - std::prev(next)->first + 1;
+}
+
+void LineIndex::modify_line(const int line, const int x, const int w, const S8 delta) {
+  Steps &steps = lines[line];
+  split_at(steps, x);
+  split_at(steps, x + w);
+  for (auto step = steps.find(x); step->first != x + w; ++step) {
+    const int count = step->second + delta;
+    if (count < 0 || count > std::numeric_limits<U8>::max()) {
+      merge_at(steps, x);
+      merge_at(steps, x + w);
+      throw std::logic_error(count < 0 ? "Underflow." : "Overflow.");
+    }
+  }
+  for (auto step = steps.find(x); step->first != x + w; ++step) {
+    step->second = static_cast<U8>(step->second + delta);
+  }
+  merge_at(steps, x);
+  merge_at(steps, x + w);
+}
+
+U8 LineIndex::get(const int x, const int y) const {
+  const int line = get_line(y);
+  if (line < 0 || x < box.min_x || x > box.max_x) {
+    return 0;
+  }
+  return static_cast<U8>(get_count_at(lines[line], x));
+}
+
+void LineIndex::modify(const int x, const int y, const int w, const int h, const S8 delta) {
+  const int min_x = std::max(x, box.min_x);
+  const int max_x = std::min(x + w - 1, box.max_x);
+  if (delta == 0 || min_x > max_x || h <= 0) {
+    return;
+  }
+  if ((y - box.min_y) % line_height != 0 || h % line_height != 0) {
+    throw std::logic_error("Rectangle is not aligned to lines.");
+  }
+  for (int line = (y - box.min_y) / line_height; line < (y + h - box.min_y) / line_height; line++) {
+    if (line >= 0 && line < static_cast<int>(lines.size())) {
+      modify_line(line, min_x, max_x - min_x + 1, delta);
+    }
+  }
+}
+
+bool LineIndex::is_free(const int x, const int y, const int w, const int h) const {
+  const int min_y = std::max(y, box.min_y);
+  const int max_y = std::min(y + h - 1, box.max_y);
+  if (w <= 0 || min_y > max_y) {
+    return true;
+  }
+  const int last_line = std::min((max_y - box.min_y) / line_height, static_cast<int>(lines.size()) - 1);
+  for (int line = (min_y - box.min_y) / line_height; line <= last_line; line++) {
+    if (!is_line_free(line, x, w)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int LineIndex::count_free_columns(const int x, const int y, const int h, const int direction, const int limit) const {
+  if (limit <= 0) {
+    return 0;
+  }
+  const int min_y = std::max(y, box.min_y);
+  const int max_y = std::min(y + h - 1, box.max_y);
+  int count = limit;
+  if (min_y > max_y) {
+    return count;
+  }
+  const int last_line = std::min((max_y - box.min_y) / line_height, static_cast<int>(lines.size()) - 1);
+  for (int line = (min_y - box.min_y) / line_height; line <= last_line; line++) {
+    count = std::min(count, count_free_line_columns(line, x, direction));
+  }
+  return count;
+}
+
+int LineIndex::count_free_rows(const int x, const int y, const int w, const int direction, const int limit) const {
+  int count = 0;
+  while (count < limit) {
+    const int row = y + direction * count;
+    /* Once past the box, every row is free. */
+    if ((direction > 0 && row > box.max_y) || (direction < 0 && row < box.min_y)) {
+      return limit;
+    }
+    /* Before the box, every row is free as well. */
+    if (row < box.min_y || row > box.max_y) {
+      count += direction > 0 ? box.min_y - row : row - box.max_y;
+      continue;
+    }
+    const int line = get_line(row);
+    if (line < 0) {
+      count++;
+      continue;
+    }
+    if (!is_line_free(line, x, w)) {
+      return count;
+    }
+    /* All the rows of a line have the same occupancy, so skip to the next one. */
+    const int start = get_line_start(line);
+    count += direction > 0 ? start + line_height - row : row - start + 1;
+  }
+  return limit;
+}
+
+int LineIndex::sweep(const int x, const int y, const int w, const int h, const int dx, const int dy, const int limit) const {
+  if (limit <= 0) {
+    return 0;
+  }
+  /* The cells which the rectangle still covers after the first step. */
+  if (dx > 0 && is_free(x + 1, y, w - 1, h)) {
+    return count_free_columns(x + w, y, h, 1, limit);
+  }
+  if (dx < 0 && is_free(x, y, w - 1, h)) {
+    return count_free_columns(x - 1, y, h, -1, limit);
+  }
+  if (dy > 0 && is_free(x, y + 1, w, h - 1)) {
+    return count_free_rows(x, y + h, w, 1, limit);
+  }
+  if (dy < 0 && is_free(x, y, w, h - 1)) {
+    return count_free_rows(x, y - 1, w, -1, limit);
+  }
+  return 0;
+}
+
+size_t LineIndex::get_memory_usage() const {
+  /* Each map node holds its value, three pointers and a color. */
+  const size_t node_size = sizeof(Steps::value_type) + 4 * sizeof(void *);
+  size_t usage = sizeof(LineIndex) + lines.capacity() * sizeof(Steps);
+  for (const auto &steps : lines) {
+    usage += steps.size() * node_size;
+  }
+  return usage;
+}
@@ -0,0 +1,80 @@
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include "box.hpp"
+#include "integers.hpp"
+#include <map>
+#include <vector>
+
+/**
+ * Occupancy of the rigid bodies of a BoundingBox, stored as sorted intervals for each tile line.
+ *
+ * Platforms always span exactly one line, so the occupancy of a line is a step function over x which gives how many
+ * platforms cover each column. Only the points where the count changes are stored, which makes memory proportional to
+ * the number of platforms instead of to the size of the box.
+ *
+ * This answers the same queries as RigidMatrix, in logarithmic time with respect to the number of platforms in a line.
+ */
+class LineIndex {
+public:
+  LineIndex() = default;
+
+  LineIndex(BoundingBox box, int line_height);
+
+  /**
+   * Returns how many rigid bodies cover the provided point.
+   */
+  U8 get(int x, int y) const;
+
+  /**
+   * Adds delta to the count of every cell of the rectangle which lies inside the box.
+   *
+   * The rectangle must cover whole lines. Throws a std::logic_error if it does not or if a count would underflow.
+   */
+  void modify(int x, int y, int w, int h, S8 delta);
+
+  /**
+   * Evaluates whether or not all the cells of the rectangle are free.
+   */
+  bool is_free(int x, int y, int w, int h) const;
+
+  /**
+   * Counts how many consecutive columns, starting at x and going in the provided direction, are free on [y, y + h).
+   *
+   * Stops counting at limit, so the result is in [0, limit].
+   */
+  int count_free_columns(int x, int y, int h, int direction, int limit) const;
+
+  /**
+   * Counts how many consecutive rows, starting at y and going in the provided direction, are free on [x, x + w).
+   *
+   * Stops counting at limit, so the result is in [0, limit].
+   */
+  int count_free_rows(int x, int y, int w, int direction, int limit) const;
+
+  /**
+   * Returns how many one-cell steps along a single axis the rectangle can take before overlapping an occupied cell.
+   *
+   * Exactly one of dx and dy should be nonzero, and only its sign is used. Stops counting at limit.
+   */
+  int sweep(int x, int y, int w, int h, int dx, int dy, int limit) const;
+
+  /**
+   * Returns an approximation of the number of bytes used by this index.
+   */
+  size_t get_memory_usage() const;
+
+private:
+  BoundingBox box;
+  int line_height = 1;
+  // For each line, maps the x where the count changes to the count from there to the next change.
+  std::vector<std::map<int, U8>> lines;
+
+  int get_line(int y) const;
+  int get_line_start(int line) const;
+  bool is_line_free(int line, int x, int w) const;
+  int count_free_line_columns(int line, int x, int direction) const;
+  void modify_line(int line, int x, int w, S8 delta);
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "line_occupancy.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * Returns how many of the furthest empty lines a gap of the provided length holds.
+ *
+ * A gap of length 2d + 1 holds two lines at distance d from the occupied lines around it, and one of length 2d only one.
+ */
+static S32 count_furthest_in_gap(const S32 length, const S32 longest) {
+  const S32 distance = longest / 2;
+  if (length == 2 * distance) {
+    return 1;
+  }
+  if (length == 2 * distance + 1) {
+    return 2;
+  }
+  return 0;
+}
+
+LineOccupancy::LineOccupancy(const U32 line_count) : line_count(line_count), counts(line_count) {
+  const size_t positions = line_count + 2;
+  leaves = 1;
+  while (leaves < positions) {
+    leaves *= 2;
+  }
+  nodes.resize(2 * leaves);
+  for (size_t i = 0; i < positions; i++) {
+    Node &leaf = nodes[leaves + i];
+    if (i == 0 || i == positions - 1) {
+      leaf.first = static_cast<S32>(i);
+      leaf.last = static_cast<S32>(i);
+    } else {
+      leaf.empty = 1;
+    }
+  }
+  for (size_t i = leaves - 1; i > 0; i--) {
+    nodes[i] = merge(nodes[2 * i], nodes[2 * i + 1]);
+  }
+}
+
+LineOccupancy::Node LineOccupancy::merge(const Node &left, const Node &right) {
+  Node node;
+  node.empty = left.empty + right.empty;
+  if (left.first == -1 || right.first == -1) {
+    const Node &occupied = left.first == -1 ? right : left;
+    node.first = occupied.first;
+    node.last = occupied.last;
+    node.longest = occupied.longest;
+    node.longest_count = occupied.longest_count;
+    node.shorter_count = occupied.shorter_count;
+    return node;
+  }
+  node.first = left.first;
+  node.last = right.last;
+  const S32 middle = right.first - left.last;
+  node.longest = std::max(middle, std::max(left.longest, right.longest));
+  for (const Node *child : {&left, &right}) {
+    if (child->longest == node.longest) {
+      node.longest_count += child->longest_count;
+      node.shorter_count += child->shorter_count;
+    } else if (child->longest == node.longest - 1) {
+      node.shorter_count += child->longest_count;
+    }
+  }
+  if (middle == node.longest) {
+    node.longest_count++;
+  } else if (middle == node.longest - 1) {
+    node.shorter_count++;
+  }
+  return node;
+}
+
+S32 LineOccupancy::count_furthest(const Node &node, const S32 longest) {
+  return node.longest_count * count_furthest_in_gap(node.longest, longest) + node.shorter_count * count_furthest_in_gap(node.longest - 1, longest);
+}
+
+void LineOccupancy::set_position(size_t position, const bool occupied) {
+  Node &leaf = nodes[leaves + position];
+  leaf.first = occupied ? static_cast<S32>(position) : -1;
+  leaf.last = leaf.first;
+  leaf.empty = occupied ? 0 : 1;
+  for (size_t i = (leaves + position) / 2; i > 0; i /= 2) {
+    nodes[i] = merge(nodes[2 * i], nodes[2 * i + 1]);
+  }
+}
+
+void LineOccupancy::add(const U32 line) {
+  if (counts[line]++ == 0) {
+    set_position(line + 1, true);
+  }
+}
+
+void LineOccupancy::remove(const U32 line) {
+  if (counts[line] == 0) {
+    throw std::logic_error("Underflow.");
+  }
+  if (--counts[line] == 0) {
+    set_position(line + 1, false);
+  }
+}
+
+U32 LineOccupancy::select_blindly(RandomGenerator &generator) const {
+  if (line_count == 0) {
+    throw std::logic_error("Empty line vector.");
+  }
+  const S32 empty_count = nodes[1].empty;
+  if (empty_count == 0) {
+    return static_cast<U32>(generator.integer(0, static_cast<int>(line_count - 1)));
+  }
+  /* Descend to the empty position with the drawn rank. */
+  S32 skip = generator.integer(0, empty_count - 1);
+  size_t i = 1;
+  while (i < leaves) {
+    if (skip < nodes[2 * i].empty) {
+      i = 2 * i;
+    } else {
+      skip -= nodes[2 * i].empty;
+      i = 2 * i + 1;
+    }
+  }
+  return static_cast<U32>(i - leaves - 1);
+}
+
+U32 LineOccupancy::select_awarely(RandomGenerator &generator) const {
+  if (line_count == 0) {
+    throw std::logic_error("Empty line vector.");
+  }
+  if (nodes[1].empty == 0) {
+    return static_cast<U32>(generator.integer(0, static_cast<int>(line_count - 1)));
+  }
+  /* The empty lines furthest from any occupied line are in the middle of the longest gaps. */
+  const S32 longest = nodes[1].longest;
+  S32 skip = generator.integer(0, count_furthest(nodes[1], longest) - 1);
+  /* Within a node, the gaps of the left child come before the gap between the children, which comes before those of
+   * the right child. */
+  size_t i = 1;
+  while (true) {
+    const Node &left = nodes[2 * i];
+    const Node &right = nodes[2 * i + 1];
+    const S32 in_left = count_furthest(left, longest);
+    if (skip < in_left) {
+      i = 2 * i;
+      continue;
+    }
+    skip -= in_left;
+    if (left.first != -1 && right.first != -1) {
+      const S32 in_middle = count_furthest_in_gap(right.first - left.last, longest);
+      if (skip < in_middle) {
+        /* Positions are one after the lines. */
+        return static_cast<U32>(left.last + longest / 2 + skip - 1);
+      }
+      skip -= in_middle;
+    }
+    i = 2 * i + 1;
+  }
+}
+
+size_t LineOccupancy::get_memory_usage() const {
+  return counts.capacity() * sizeof(U32) + nodes.capacity() * sizeof(Node);
+}
+
+LineBuckets::LineBuckets(const U32 line_count) : buckets(line_count) {
+}
+
+void LineBuckets::add(const U32 line, const U32 platform) {
+  if (platform >= positions.size()) {
+    positions.resize(platform + 1);
+  }
+  positions[platform] = static_cast<U32>(buckets[line].size());
+  buckets[line].push_back(platform);
+}
+
+void LineBuckets::remove(const U32 line, const U32 platform) {
+  std::vector<U32> &bucket = buckets[line];
+  if (platform >= positions.size() || positions[platform] >= bucket.size() || bucket[positions[platform]] != platform) {
+    throw std::logic_error("Platform is not on the line.");
+  }
+  const U32 position = positions[platform];
+  bucket[position] = bucket.back();
+  positions[bucket[position]] = position;
+  bucket.pop_back();
+}
+
+size_t LineBuckets::get_memory_usage() const {
+  size_t usage = buckets.capacity() * sizeof(std::vector<U32>) + positions.capacity() * sizeof(U32);
+  for (const auto &bucket : buckets) {
+    usage += bucket.capacity() * sizeof(U32);
+  }
+  return usage;
+}
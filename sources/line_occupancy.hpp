@@ -0,0 +1,117 @@
+#ifndef LINE_OCCUPANCY_H
+#define LINE_OCCUPANCY_H
+
+#include "integers.hpp"
+#include "random.hpp"
+#include <vector>
+
+/**
+ * How many platforms are on each tile line, with a segment tree over the gaps between the occupied lines.
+ *
+ * Platforms are added and removed as they move between lines, so choosing a line for a platform does not require
+ * scanning all the platforms. The selections draw from the generator exactly as select_random_line_blindly and
+ * select_random_line_awarely do for the equivalent occupancy vector.
+ */
+class LineOccupancy {
+public:
+  LineOccupancy() = default;
+
+  explicit LineOccupancy(U32 line_count);
+
+  inline U32 get_line_count() const {
+    return line_count;
+  }
+
+  /**
+   * Returns how many platforms are on the provided line.
+   */
+  inline U32 get(const U32 line) const {
+    return counts[line];
+  }
+
+  void add(U32 line);
+
+  /**
+   * Removes a platform from the provided line. Throws a std::logic_error if the line is empty.
+   */
+  void remove(U32 line);
+
+  /**
+   * Selects at random an empty line. If there is no such line, returns a random line.
+   *
+   * This is O(lg n) with respect to the number of lines.
+   */
+  U32 select_blindly(RandomGenerator &generator) const;
+
+  /**
+   * Selects at random one of the lines which are the furthest away from any occupied line.
+   *
+   * This is O(lg n) with respect to the number of lines.
+   */
+  U32 select_awarely(RandomGenerator &generator) const;
+
+  size_t get_memory_usage() const;
+
+private:
+  /**
+   * A range of positions. Position 0 and the position after the last line are always occupied, so that the borders
+   * count as occupied lines.
+   *
+   * A gap is the distance between two consecutive occupied positions of the range. Only the longest gaps and those one
+   * shorter than them are counted, because those are the only ones which can hold the furthest empty lines.
+   */
+  class Node {
+  public:
+    // The first and the last occupied positions, or -1 if the range has none.
+    S32 first = -1;
+    S32 last = -1;
+    S32 longest = 0;
+    S32 longest_count = 0;
+    S32 shorter_count = 0;
+    S32 empty = 0;
+  };
+
+  U32 line_count = 0;
+  std::vector<U32> counts;
+  size_t leaves = 0;
+  std::vector<Node> nodes;
+
+  static Node merge(const Node &left, const Node &right);
+
+  void set_position(size_t position, bool occupied);
+
+  /**
+   * Returns how many of the furthest empty lines the gaps of the node hold, given the longest gap of all lines.
+   */
+  static S32 count_furthest(const Node &node, S32 longest);
+};
+
+/**
+ * The indices of the platforms on each tile line, in no particular order.
+ */
+class LineBuckets {
+public:
+  LineBuckets() = default;
+
+  explicit LineBuckets(U32 line_count);
+
+  inline const std::vector<U32> &get(const U32 line) const {
+    return buckets[line];
+  }
+
+  void add(U32 line, U32 platform);
+
+  /**
+   * Removes a platform from the provided line. Throws a std::logic_error if it is not there.
+   */
+  void remove(U32 line, U32 platform);
+
+  size_t get_memory_usage() const;
+
+private:
+  std::vector<std::vector<U32>> buckets;
+  // Where each platform is in its bucket, so that removing it takes constant time.
+  std::vector<U32> positions;
+};
+
+#endif
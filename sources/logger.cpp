@@ -7,6 +7,7 @@
 #include "version.hpp"
 #include <cstdio>
 #include <ctime>
+#include <mutex>
 
 #define LOGGER_VERSION_MESSAGE "Version is " WALLS_OF_DOOM_VERSION "."
 
@@ -19,6 +20,9 @@
 
 #define LOG_MESSAGE_SIZE (TIMESTAMP_BUFFER_SIZE + 256)
 
+/* Games may run on several threads at once, so writes to the log files are serialized. */
+static std::mutex logger_mutex;
+
 /**
  * Initializes the logger. Should only be called once.
  */
@@ -74,6 +78,7 @@ void log_message(const std::string &message) {
   char string[LOG_MESSAGE_SIZE];
   /* get_full_path does not use dynamic memory allocation. */
   get_full_path(path, LOG_FILE_NAME);
+  std::lock_guard<std::mutex> lock(logger_mutex);
   /* write_timestamp does not use dynamic memory allocation. */
   write_timestamp(stamp, TIMESTAMP_BUFFER_SIZE);
   sprintf(string, "[%s] %s", stamp, message.c_str());
@@ -87,6 +92,7 @@ void log_player_score(const Settings &settings, const U64 frame, const Score sco
   if (settings.is_logging_player_score() != 0) {
     get_full_path(path, SCORE_FILE_NAME);
     sprintf(string, "%ld,%ld", frame, score);
+    std::lock_guard<std::mutex> lock(logger_mutex);
     append_to_file(path, string);
   }
 }
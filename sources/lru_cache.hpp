@@ -0,0 +1,79 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * A bounded map from strings to values which keeps track of which entry was used least recently.
+ *
+ * The cache never drops a value by itself. The owner evicts the least recently used value when the cache is full, so
+ * that it can release or reuse what the value holds.
+ */
+template <typename Value> class LruCache {
+public:
+  /**
+   * Creates a cache which holds up to capacity entries. Throws a std::logic_error if capacity is zero.
+   */
+  explicit LruCache(size_t capacity) : capacity(capacity) {
+    if (capacity == 0) {
+      throw std::logic_error("Capacity is zero.");
+    }
+  }
+
+  inline size_t size() const {
+    return entries.size();
+  }
+
+  inline bool is_full() const {
+    return entries.size() == capacity;
+  }
+
+  /**
+   * Returns the value of the key and makes it the most recently used, or returns nullptr if the key is not cached.
+   */
+  Value *find(const std::string &key) {
+    const auto found = index.find(key);
+    if (found == index.end()) {
+      return nullptr;
+    }
+    entries.splice(entries.begin(), entries, found->second);
+    return &found->second->second;
+  }
+
+  /**
+   * Adds a key which is not cached as the most recently used. Throws a std::logic_error if the cache is full.
+   */
+  Value &insert(const std::string &key, Value value) {
+    if (is_full()) {
+      throw std::logic_error("Inserted into a full cache.");
+    }
+    entries.emplace_front(key, std::move(value));
+    index[key] = entries.begin();
+    return entries.front().second;
+  }
+
+  /**
+   * Removes the least recently used entry and returns its value. Throws a std::logic_error if the cache is empty.
+   */
+  Value evict() {
+    if (entries.empty()) {
+      throw std::logic_error("Evicted from an empty cache.");
+    }
+    Value value = std::move(entries.back().second);
+    index.erase(entries.back().first);
+    entries.pop_back();
+    return value;
+  }
+
+private:
+  size_t capacity;
+  // The entries, from the most recently used to the least recently used.
+  std::list<std::pair<std::string, Value>> entries;
+  std::unordered_map<std::string, typename std::list<std::pair<std::string, Value>>::iterator> index;
+};
+
+#endif
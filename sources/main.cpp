@@ -16,11 +16,23 @@ void log_unrecognized_argument(const std::string &argument) {
   log_message(string);
 }
 
-ParserResult parse_argument(const char *argument) {
+/**
+ * Parses the argument at the provided index, advancing the index past any value it consumes.
+ */
+ParserResult parse_argument(int argc, char *argv[], int &index, U64 &seed) {
+  const char *argument = argv[index];
   if (string_equals(argument, "--version")) {
     printf("%s\n", WALLS_OF_DOOM_VERSION);
     return PARSER_RESULT_QUIT;
   }
+  if (string_equals(argument, "--seed") && index + 1 < argc) {
+    try {
+      seed = string_to_unsigned(argv[++index]);
+      return PARSER_RESULT_CONTINUE;
+    } catch (std::invalid_argument &exception) {
+      log_message(exception.what());
+    }
+  }
   log_unrecognized_argument(argument);
   return PARSER_RESULT_QUIT;
 }
@@ -29,9 +41,10 @@ ParserResult parse_argument(const char *argument) {
 int main(int argc, char *argv[]) {
   int quit = 0;
   int result = 0;
+  U64 seed = 0;
   if (argc > 1) {
     for (int i = 1; i < argc && (quit == 0); i++) {
-      if (parse_argument(argv[i]) == PARSER_RESULT_QUIT) {
+      if (parse_argument(argc, argv, i, seed) == PARSER_RESULT_QUIT) {
         quit = 1;
       }
     }
@@ -42,6 +55,9 @@ int main(int argc, char *argv[]) {
   try {
     seed_random();
     Settings settings(settings_filename);
+    if (seed != 0) {
+      settings.set_random_seed(seed);
+    }
     SDL_Window *window;
     SDL_Renderer *renderer;
     initialize(settings, &window, &renderer);
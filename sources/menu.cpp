@@ -47,7 +47,7 @@ Code game(const Settings &settings, Profiler *profiler, SDL_Renderer *renderer,
     return code;
   }
   Player player(name, table);
-  Game game(&player, &settings, profiler);
+  Game game(&player, &settings, profiler, get_game_seed(settings));
   return run_game(&game, renderer);
 }
 
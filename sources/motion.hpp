@@ -0,0 +1,31 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "integers.hpp"
+
+/**
+ * Returns floor(ticks * speed / period) for a nonnegative speed, split so that the product does not overflow.
+ */
+inline S64 get_motion_distance(const U64 ticks, const S64 speed, const U32 period) {
+  const auto periods = static_cast<S64>(ticks / period);
+  const auto remainder = static_cast<S64>(ticks % period);
+  return periods * speed + remainder * speed / period;
+}
+
+/**
+ * Returns how many whole units something moving at speed units per period covers over ticks [first, first + ticks).
+ *
+ * Each tick covers the whole units that its end passes, so the movement of a tick only depends on the tick modulo the
+ * period and the movements of consecutive ticks add up exactly. This uses only integer arithmetic, so it gives the same
+ * results with every compiler and on every architecture.
+ */
+inline S64 get_motion(const U64 first, const U64 ticks, const S64 speed, const U32 period) {
+  if (speed < 0) {
+    return -get_motion(first, ticks, -speed, period);
+  }
+  /* Start a period later, which does not change the movement, so that tick 0 has a tick before it. */
+  const U64 start = first % period + period - 1;
+  return get_motion_distance(start + ticks, speed, period) - get_motion_distance(start, speed, period);
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include "physics.hpp"
+#include "motion.hpp"
+#include <algorithm>
 
 /* Should be the maximum frame count value for 5 seconds remaining. */
 #define MINIMUM_REMAINING_FRAMES_FOR_MESSAGE (6 * UPS - 1)
@@ -23,12 +25,7 @@ static BoundingBox derive_box(const Game *game, const int x, const int y) {
 }
 
 static bool has_rigid_support(const Game *game, int x, int y, int w, int h) {
-  for (int i = 0; i < w; i++) {
-    if (get_from_rigid_matrix(game, x + i, y + h) != 0u) {
-      return true;
-    }
-  }
-  return false;
+  return !game->collider.is_free(x, y + h, w, 1);
 }
 
 static bool is_over_platform(const Player *player, const Platform *const platform) {
@@ -42,14 +39,7 @@ static bool is_over_platform(const Player *player, const Platform *const platfor
 
 /* Width and height are the width and height of the matrix tile. */
 static bool violates_rigid_matrix(const Game *game, int x, int y, int w, int h) {
-  for (int i = 0; i < w; i++) {
-    for (int j = 0; j < h; j++) {
-      if (get_from_rigid_matrix(game, x + i, y + j) != 0) {
-        return true;
-      }
-    }
-  }
-  return false;
+  return !game->collider.is_free(x, y, w, h);
 }
 
 /**
@@ -74,6 +64,40 @@ static bool is_valid_move(const Game *const game, const int x, const int y) {
   return !violates_rigid_matrix(game, x, y, game->player->w, game->player->h);
 }
 
+/**
+ * Limits a distance along an axis so that the player stops right before the provided wall coordinate.
+ *
+ * A direction of zero means that the player does not move along this axis, so it cannot move at all if it is on the wall.
+ */
+static int stop_before_wall(const int distance, const int position, const int direction, const int wall) {
+  if (direction == 0) {
+    return position == wall ? 0 : distance;
+  }
+  const int steps = (wall - position) * direction;
+  if (steps > 0) {
+    return std::min(distance, steps - 1);
+  }
+  return distance;
+}
+
+/**
+ * Returns how many times, up to limit, move_player with the provided direction would move the player.
+ *
+ * This is a single swept query instead of one full tile test per position.
+ */
+static int get_free_player_distance(const Game *const game, const int dx, const int dy, const int limit) {
+  const Player *const player = game->player;
+  int distance = game->collider.sweep(player->x, player->y, player->w, player->h, dx, dy, limit);
+  if (player->perk == PERK_POWER_INVINCIBILITY) {
+    /* The same walls is_valid_move keeps the invincible player from moving into. */
+    distance = stop_before_wall(distance, player->x, dx, game->box.min_x - 1);
+    distance = stop_before_wall(distance, player->x, dx, game->box.max_x + 2 - player->w);
+    distance = stop_before_wall(distance, player->y, dy, game->box.min_y - 1);
+    distance = stop_before_wall(distance, player->y, dy, game->box.max_y + 2 - player->h);
+  }
+  return distance;
+}
+
 /**
  * Moves the player by the provided x and y directions.
  *
@@ -97,14 +121,7 @@ static void move_player(Game *game, int dx, int dy) {
 static bool can_move_player_without_intersecting(Game *game, int dx, int dy) {
   const S32 tile_w = game->settings->get_tile_w();
   const S32 tile_h = game->settings->get_tile_h();
-  for (auto x = game->player->x + dx; x < game->player->x + dx + tile_w; x++) {
-    for (auto y = game->player->y + dy; y < game->player->y + dy + tile_h; y++) {
-      if (get_from_rigid_matrix(game, x, y) != 0u) {
-        return false;
-      }
-    }
-  }
-  return true;
+  return game->collider.is_free(game->player->x + dx, game->player->y + dy, tile_w, tile_h);
 }
 
 /**
@@ -129,39 +146,33 @@ static ShoveResult shove_player(Game *game, int dx, int dy, bool standing) {
   return ShoveResult::ShoveSuccess;
 }
 
-static int get_absolute_pending_movement(U64 frame, int speed) {
-  // Should move slice after every frame.
-  const auto slice = speed / static_cast<double>(UPS);
-  // To reduce floating point error, normalize frame to [FPS, 2 FPS - 1].
-  frame = frame % UPS + UPS;
-  return static_cast<int>(std::floor(frame * slice) - std::floor((frame - 1) * slice));
-}
-
+/**
+ * Returns how many pixels the player moves on this tick at a speed in pixels per second.
+ */
 static int get_pending_movement(const Game *const game, const int speed) {
-  return normalize(speed) * get_absolute_pending_movement(game->current_frame, abs(speed));
+  return static_cast<int>(get_motion(game->current_frame, 1, speed, UPS));
 }
 
-static void subtract_platform(Game *const game, Platform *const platform) {
-  modify_rigid_matrix_platform(game, platform, -1);
+/**
+ * Returns how many pixels a platform moves on this tick if nothing stops it.
+ */
+static int get_platform_step(const Game *const game, const S32 speed) {
+  return static_cast<int>(get_motion(game->current_frame, 1, speed, SUBPIXELS_PER_PIXEL));
 }
 
-static void add_platform(Game *const game, Platform *const platform) {
-  modify_rigid_matrix_platform(game, platform, 1);
+/**
+ * Returns the most pixels a platform can move on a single tick.
+ */
+static S64 get_maximum_platform_step(const S32 speed) {
+  return (std::abs(static_cast<S64>(speed)) + SUBPIXELS_PER_PIXEL - 1) / SUBPIXELS_PER_PIXEL;
 }
 
-static bool is_free_on_matrix(Game *const game, int x, int y, int w, int h) {
-  for (int i = 0; i != w; i++) {
-    for (int j = 0; j != h; j++) {
-      if (get_from_rigid_matrix(game, x + i, y + j) != 0u) {
-        return false;
-      }
-    }
-  }
-  return true;
+static void subtract_platform(Game *const game, const size_t index, Platform *const platform) {
+  modify_rigid_matrix_platform(game, index, platform, -1);
 }
 
-static bool can_insert_platform(Game *const game, Platform *const p) {
-  return is_free_on_matrix(game, p->x, p->y, p->w, p->h);
+static void add_platform(Game *const game, const size_t index, Platform *const platform) {
+  modify_rigid_matrix_platform(game, index, platform, 1);
 }
 
 /**
@@ -198,43 +209,7 @@ static bool is_in_front_of_platform(const Player *const player, const Platform *
   return false;
 }
 
-static bool can_move_platform(Game *const game, Platform *p, int dx, int dy) {
-  if (game->settings->get_player_stops_platforms() && is_over_platform(game->player, p)) {
-    return false;
-  }
-  if (dx == 0 && dy == 0) {
-    return true;
-  }
-  auto can_move = true;
-  // There are two optimized paths for unidirectional movement.
-  if (dx == 0) {
-    if (dy < 0) {
-      return is_free_on_matrix(game, p->x, p->y + dy, p->w, -dy);
-    }
-    if (dy > 0) {
-      return is_free_on_matrix(game, p->x, p->y + p->h, p->w, dy);
-    }
-  } else if (dy == 0) {
-    if (dx < 0) {
-      return is_free_on_matrix(game, p->x + dx, p->y, -dx, p->h);
-    }
-    if (dx > 0) {
-      return is_free_on_matrix(game, p->x + p->w, p->y, dx, p->h);
-    }
-  } else {
-    // If the platform would intersect with another platform, do not move it.
-    subtract_platform(game, p);
-    p->x += dx;
-    p->y += dy;
-    can_move = can_insert_platform(game, p);
-    p->x -= dx;
-    p->y -= dy;
-    add_platform(game, p);
-  }
-  return can_move;
-}
-
-static void slide_platform_on_x(Game *const game, Platform *const p, const int dx) {
+void slide_platform_on_x(Game *const game, Platform *const p, const int dx) {
   if (dx == 0) {
     throw std::logic_error("Bad call.");
   }
@@ -248,55 +223,86 @@ static void slide_platform_on_x(Game *const game, Platform *const p, const int d
     subB = std::max(p->x, p->x + p->w - size);
     addB = p->x + dx;
   }
-  for (int x = subB; x < subB + size; x++) {
-    for (int y = p->y; y < p->y + p->h; y++) {
-      modify_rigid_matrix_point(game, x, y, -1);
-    }
-  }
-  for (int x = addB; x < addB + size; x++) {
-    for (int y = p->y; y < p->y + p->h; y++) {
-      modify_rigid_matrix_point(game, x, y, +1);
-    }
-  }
+  game->collider.modify(subB, p->y, size, p->h, -1);
+  game->collider.modify(addB, p->y, size, p->h, +1);
   p->x += dx;
 }
 
 /**
- * This function is the ONLY right way to move a platform.
+ * Returns how many pixels the platform can move in its direction before hitting another rigid body, up to limit.
+ */
+static int get_free_distance(const Game *const game, const Platform *const platform, const int limit) {
+  if (platform->speed < 0) {
+    return game->collider.count_free_columns(platform->x - 1, platform->y, platform->h, -1, limit);
+  }
+  return game->collider.count_free_columns(platform->x + platform->w, platform->y, platform->h, 1, limit);
+}
+
+/**
+ * Returns how many pixels the platform can move in its direction before the player is in front of it or over it.
  *
- * This function keeps the cached rigid body matrix in the Game object valid.
+ * Returns the maximum int if the player is never going to be in front of or over the platform.
  */
-static void move_platform(Game *const game, Platform *const platform, const int dx, const int dy) {
-  if (can_move_platform(game, platform, dx, dy)) {
-    slide_platform_on_x(game, platform, dx);
-    if (dy != 0) {
-      throw std::logic_error("Not implemented.");
+static int get_distance_to_player(const Player *const player, const Platform *const platform) {
+  auto distance = std::numeric_limits<int>::max();
+  const auto ahead = platform->speed < 0 ? platform->x - (player->x + player->w) : player->x - (platform->x + platform->w);
+  const auto behind = platform->speed < 0 ? platform->x + platform->w - player->x : player->x + player->w - platform->x;
+  if (player->y < platform->y + platform->h && player->y + player->h > platform->y) {
+    if (ahead >= 0) {
+      distance = ahead;
+    }
+  } else if (player->y + player->h == platform->y) {
+    // The platform is under the player from the moment it passes the player's leading edge to when it passes the other.
+    const auto under = std::max(0, ahead + 1);
+    if (under < behind) {
+      distance = under;
     }
   }
+  return distance;
 }
 
-static void move_platform_horizontally(Game *const game, Platform *const platform) {
-  int normalized_speed = normalize(platform->speed);
-  /* This could be made more efficient by handling each direction separately. */
-  int pending = abs(platform->speed);
-  while (pending != 0) {
-    if (can_move_platform(game, platform, normalized_speed, 0)) {
-      if (is_in_front_of_platform(game->player, platform)) {
-        const auto shove_result = shove_player(game, normalized_speed, 0, false);
-        if (shove_result == ShoveResult::ShoveFailure) {
-          break;
-        }
-      }
-      if (is_over_platform(game->player, platform)) {
-        shove_player(game, normalized_speed, 0, true);
+/**
+ * This function is the ONLY right way to move a platform.
+ *
+ * No other rigid body moves while a platform does, so its free distance is found with a single query and the whole
+ * displacement is applied to the cached rigid body matrix at once. The platform only advances one pixel at a time while
+ * it is shoving the player.
+ */
+static void move_platform_horizontally(Game *const game, Platform *const platform, const int step) {
+  const int direction = normalize(platform->speed);
+  const int free = get_free_distance(game, platform, abs(step));
+  const int origin = platform->x;
+  int moved = 0;
+  while (moved < free) {
+    const int skipped = std::min(free - moved, get_distance_to_player(game->player, platform));
+    platform->x += direction * skipped;
+    moved += skipped;
+    if (moved == free) {
+      break;
+    }
+    if (game->settings->get_player_stops_platforms() && is_over_platform(game->player, platform)) {
+      break;
+    }
+    if (is_in_front_of_platform(game->player, platform)) {
+      const auto shove_result = shove_player(game, direction, 0, false);
+      if (shove_result == ShoveResult::ShoveFailure) {
+        break;
       }
-      move_platform(game, platform, normalized_speed, 0);
     }
-    pending--;
+    if (is_over_platform(game->player, platform)) {
+      shove_player(game, direction, 0, true);
+    }
+    platform->x += direction;
+    moved++;
+  }
+  const int destination = platform->x;
+  if (destination != origin) {
+    platform->x = origin;
+    slide_platform_on_x(game, platform, destination - origin);
   }
 }
 
-int select_random_line_blindly(const std::vector<unsigned char> &lines) {
+int select_random_line_blindly(const std::vector<unsigned char> &lines, RandomGenerator &generator) {
   if (lines.empty()) {
     throw std::logic_error("Empty line vector.");
   }
@@ -309,10 +315,10 @@ int select_random_line_blindly(const std::vector<unsigned char> &lines) {
   }
   /* No empty lines, return any line. */
   if (count == 0) {
-    return random_integer(0, static_cast<int>(lines.size() - 1));
+    return generator.integer(0, static_cast<int>(lines.size() - 1));
   }
   /* Get a random value based on the count. */
-  int skip = random_integer(0, count - 1);
+  int skip = generator.integer(0, count - 1);
   int line = 0;
   while ((lines[line] != 0) || skip != 0) {
     if (lines[line] == 0) {
@@ -323,7 +329,7 @@ int select_random_line_blindly(const std::vector<unsigned char> &lines) {
   return line;
 }
 
-int select_random_line_awarely(const std::vector<unsigned char> &lines) {
+int select_random_line_awarely(const std::vector<unsigned char> &lines, RandomGenerator &generator) {
   if (lines.empty()) {
     throw std::logic_error("Empty line vector.");
   }
@@ -363,7 +369,7 @@ int select_random_line_awarely(const std::vector<unsigned char> &lines) {
     }
   }
   /* Get a random value based on the count. */
-  int skip = random_integer(0, count - 1);
+  int skip = generator.integer(0, count - 1);
   int line = 0;
   while (distances[line] != maximum_distance || skip != 0) {
     if (distances[line] == maximum_distance) {
@@ -374,39 +380,26 @@ int select_random_line_awarely(const std::vector<unsigned char> &lines) {
   return line;
 }
 
-static void reposition(Game *const game, Platform *const platform) {
+void reposition_platform(Game *const game, const size_t index, Platform *const platform) {
   const auto box = game->box;
-  // The occupied size may be smaller than the array actually is.
-  const auto settings = game->settings;
-  const auto bar_height = settings->get_bar_height();
-  const auto tile_h = game->tile_h;
-  const auto occupied_size = static_cast<U32>((settings->get_window_height() - 2 * bar_height) / tile_h);
-  std::vector<U8> occupied(occupied_size);
-  /* Build a table of occupied rows. */
-  for (size_t i = 0; i < game->platform_count; i++) {
-    if (game->platforms[i] != *platform) {
-      occupied[(game->platforms[i].y - box.min_y) / tile_h] = 1;
-    }
-  }
-  int line;
+  /* Removing the platform first leaves the occupancy of the other platforms to choose from. */
+  subtract_platform(game, index, platform);
+  U32 line;
   if (game->settings->get_reposition_algorithm() == REPOSITION_SELECT_BLINDLY) {
-    line = select_random_line_blindly(occupied);
+    line = game->lines.select_blindly(game->generator);
   } else {
-    line = select_random_line_awarely(occupied);
+    line = game->lines.select_awarely(game->generator);
   }
   if (platform->x > box.max_x) {
-    subtract_platform(game, platform);
     /* The platform should be one tick inside the box. */
     platform->x = box.min_x - platform->w + 1;
-    platform->y = box.min_y + tile_h * line;
-    add_platform(game, platform);
+    platform->y = box.min_y + game->tile_h * static_cast<int>(line);
   } else if (platform->x + platform->w < box.min_x) {
-    subtract_platform(game, platform);
     /* The platform should be one tick inside the box. */
     platform->x = box.max_x;
-    platform->y = box.min_y + tile_h * line;
-    add_platform(game, platform);
+    platform->y = box.min_y + game->tile_h * static_cast<int>(line);
   }
+  add_platform(game, index, platform);
 }
 
 /**
@@ -428,17 +421,19 @@ int is_out_of_bounding_box(Platform *const platform, const BoundingBox *const bo
   return 0;
 }
 
-static void update_platform(Game *const game, Platform *const platform) {
-  move_platform_horizontally(game, platform);
-  if (is_out_of_bounding_box(platform, &game->box) != 0) {
-    reposition(game, platform);
+static void update_platform(Game *const game, const size_t index) {
+  Platform platform = game->platforms.get(index);
+  move_platform_horizontally(game, &platform, get_platform_step(game, platform.speed));
+  if (is_out_of_bounding_box(&platform, &game->box) != 0) {
+    reposition_platform(game, index, &platform);
   }
+  game->platforms.set(index, platform);
 }
 
 void update_platforms(Game *const game) {
   if (game->player->perk != PERK_POWER_TIME_STOP) {
     for (size_t i = 0; i < game->platform_count; i++) {
-      update_platform(game, game->platforms.data() + i);
+      update_platform(game, i);
     }
   }
 }
@@ -463,6 +458,36 @@ static bool is_touching_a_wall(const Game *const game) {
   return in_x || in_y;
 }
 
+/**
+ * Records what the player touches in its current position.
+ *
+ * The platforms which support the player are looked up in the bucket of the line just below it, so this does not scan
+ * all the platforms.
+ */
+static void update_player_contact(Game *const game) {
+  const Player *const player = game->player;
+  PlayerContact &contact = game->contact;
+  contact.standing = is_standing_on_platform(game);
+  contact.touching_wall = is_touching_a_wall(game);
+  contact.supports.clear();
+  const int bottom = player->y + player->h - game->box.min_y;
+  if (!contact.standing || bottom < 0 || bottom % game->tile_h != 0) {
+    return;
+  }
+  const auto line = static_cast<U32>(bottom / game->tile_h);
+  if (line >= game->lines.get_line_count()) {
+    return;
+  }
+  const PlatformStore &platforms = game->platforms;
+  for (const U32 index : game->line_platforms.get(line)) {
+    if (player->x < platforms.x[index] + platforms.w[index] && player->x + player->w > platforms.x[index]) {
+      contact.supports.push_back(index);
+    }
+  }
+  /* Score in platform order, as a scan of all the platforms would. */
+  std::sort(contact.supports.begin(), contact.supports.end());
+}
+
 static int get_bounding_box_center_x(const BoundingBox *const box) {
   return box->min_x + (box->max_x - box->min_x + 1) / 2;
 }
@@ -491,17 +516,15 @@ void conceive_bonus(Player *const player, const Perk perk) {
   }
 }
 
-static void accelerate_platform(Platform *const platform) {
-  platform->speed = platform->speed + platform->speed / 2;
-}
-
-static void reverse_platform(Platform *const platform) {
-  platform->speed = -platform->speed;
+static void accelerate_platforms(Game *const game) {
+  for (S32 &speed : game->platforms.speed) {
+    speed = speed + speed / 2;
+  }
 }
 
-static void apply_to_platforms(Game *const game, void (*f)(Platform *const)) {
-  for (size_t i = 0; i != game->platform_count; ++i) {
-    f(game->platforms.data() + i);
+static void reverse_platforms(Game *const game) {
+  for (S32 &speed : game->platforms.speed) {
+    speed = -speed;
   }
 }
 
@@ -511,9 +534,9 @@ static void apply_to_platforms(Game *const game, void (*f)(Platform *const)) {
 void process_curse(Game *const game, const Perk perk) {
   if (is_curse_perk(perk)) {
     if (perk == PERK_CURSE_ACCELERATE_PLATFORMS) {
-      apply_to_platforms(game, accelerate_platform);
+      accelerate_platforms(game);
     } else if (perk == PERK_CURSE_REVERSE_PLATFORMS) {
-      apply_to_platforms(game, reverse_platform);
+      reverse_platforms(game);
     }
   } else {
     log_message("Called process_curse with a Perk that is not a curse!");
@@ -527,10 +550,10 @@ void update_perk(Game *const game) {
   if (game->played_frames == game->perk_end_frame) {
     game->perk = PERK_NONE;
   } else if (game->played_frames == next_perk_frame) {
-    game->perk = get_random_perk();
-    game->perk_x = random_integer(0, game->settings->get_window_width() - game->settings->get_tile_w());
+    game->perk = get_random_perk(game->generator);
+    game->perk_x = game->generator.integer(0, game->settings->get_playfield_width() - game->settings->get_tile_w());
     const auto bar_height = game->settings->get_bar_height();
-    const auto random_y = random_integer(bar_height, game->settings->get_window_height() - 2 * bar_height);
+    const auto random_y = game->generator.integer(bar_height, game->settings->get_playfield_height());
     game->perk_y = random_y - random_y % game->settings->get_tile_h();
     game->perk_end_frame = game->played_frames + game->settings->get_perk_screen_duration() * UPS;
   }
@@ -540,14 +563,10 @@ void update_perk(Game *const game) {
  * Moves the player according to the sign of its current speed if it can move in that direction.
  */
 void update_player_horizontal_position(Game *game) {
-  int pending_movement = get_pending_movement(game, game->player->speed_x);
-  while (pending_movement > 0) {
-    move_player(game, 1, 0);
-    pending_movement--;
-  }
-  while (pending_movement < 0) {
-    move_player(game, -1, 0);
-    pending_movement++;
+  const int pending_movement = get_pending_movement(game, game->player->speed_x);
+  const int direction = normalize(pending_movement);
+  if (direction != 0) {
+    game->player->x += direction * get_free_player_distance(game, direction, 0, abs(pending_movement));
   }
 }
 
@@ -557,7 +576,7 @@ static bool is_jumping(const Player *const player) {
 
 void process_jump(Game *const game) {
   const int jumping_height = game->tile_h * PLAYER_JUMPING_HEIGHT;
-  if (is_standing_on_platform(game)) {
+  if (game->contact.standing) {
     game->player->remaining_jump_height = jumping_height;
     if (game->player->perk == PERK_POWER_SUPER_JUMP) {
       game->player->remaining_jump_height *= 2;
@@ -608,9 +627,10 @@ void process_command(Game *game, Player *player) {
 static void check_for_player_death(Game *game) {
   Player *player = game->player;
   /* Kill the player if it is touching a wall. */
-  if (is_touching_a_wall(game)) {
+  if (game->contact.touching_wall) {
     player->lives--;
     reposition_player(game);
+    update_player_contact(game);
     /* Unset physics collisions for the player. */
     player->physics = false;
     player->speed_x = 0;
@@ -625,12 +645,7 @@ static bool can_move_up(const Game *game) {
   if (y == game->box.min_y) {
     return true;
   }
-  for (S32 i = 0; i < static_cast<S32>(game->settings->get_tile_w()); i++) {
-    if (get_from_rigid_matrix(game, x + i, y - 1) != 0u) {
-      return false;
-    }
-  }
-  return true;
+  return game->collider.is_free(x, y - 1, game->settings->get_tile_w(), 1);
 }
 
 /**
@@ -641,11 +656,10 @@ void update_player_vertical_position(Game *game) {
   const int falling_speed = PLAYER_FALLING_SPEED * game->tile_h;
   if (is_jumping(game->player)) {
     if (can_move_up(game)) {
-      int pending = get_pending_movement(game, jumping_speed);
-      while (pending > 0) {
-        move_player(game, 0, -1);
-        game->player->remaining_jump_height--;
-        pending--;
+      const int pending = get_pending_movement(game, jumping_speed);
+      if (pending > 0) {
+        game->player->y -= get_free_player_distance(game, 0, -1, pending);
+        game->player->remaining_jump_height -= pending;
       }
     } else {
       game->player->remaining_jump_height = 0;
@@ -657,15 +671,14 @@ void update_player_vertical_position(Game *game) {
     } else {
       pending = get_pending_movement(game, falling_speed);
     }
-    while (pending > 0) {
-      move_player(game, 0, 1);
-      pending--;
+    if (pending > 0) {
+      game->player->y += get_free_player_distance(game, 0, 1, pending);
     }
   }
 }
 
 void update_double_jump(Game *game) {
-  if (is_standing_on_platform(game)) {
+  if (game->contact.standing) {
     game->player->can_double_jump = 1;
   }
 }
@@ -761,25 +774,130 @@ void update_player(Game *game, Player *player) {
   }
   update_player_graphics(game);
   update_player_perk(game);
+  /* The platforms have moved since the last tick, so the contact is recorded again before jumping. */
+  update_player_contact(game);
   process_command(game, player);
   // This ordering makes the player run horizontally before falling.
   // This seems to be the expected order from an user point-of-view.
   update_player_horizontal_position(game);
   /* After moving, if it even happened, simulate jumping and falling. */
   update_player_vertical_position(game);
+  update_player_contact(game);
   /* Enable double jump if the player is standing over a platform. */
   update_double_jump(game);
   check_for_player_death(game);
-  if (is_standing_on_platform(game)) {
-    for (const auto &platform : game->platforms) {
-      if (platform.y == player->y + player->h) {
-        if (player->x < platform.x + platform.w) {
-          if (player->x + player->w > platform.x) {
-            player->increment_score_from_event(platform.rarity);
-          }
+  if (game->contact.standing) {
+    for (const U32 index : game->contact.supports) {
+      player->increment_score_from_event(game->platforms.rarity[index]);
+    }
+  }
+  game->profiler->stop();
+}
+
+/**
+ * Lowers limit to the number of ticks after which something closing in at the provided speed is still distance away.
+ */
+static void limit_approach(U64 &limit, const S64 distance, const S64 closing_speed) {
+  if (distance < 0) {
+    limit = 0;
+  } else if (closing_speed > 0) {
+    limit = std::min(limit, static_cast<U64>(distance / closing_speed));
+  }
+}
+
+/**
+ * Returns how many of the next ticks, up to limit, only move platforms by their speed, if no command is given on them.
+ *
+ * This requires an inactive player, so that no frame is played, and no perk to appear or disappear. Over these ticks,
+ * every platform must stay in the box and out of the way of the player and of the platforms next to it. Then no
+ * platform is repositioned or stopped, and the player is never shoved, supported or killed.
+ */
+static U64 count_quiet_ticks(Game *const game, U64 limit) {
+  const Player *const player = game->player;
+  if (player->physics || player->remaining_jump_height != 0) {
+    return 0;
+  }
+  if (is_standing_on_platform(game) || is_touching_a_wall(game)) {
+    return 0;
+  }
+  const U64 next_perk_frame = game->perk_end_frame + (game->settings->get_perk_interval() - game->settings->get_perk_screen_duration()) * UPS;
+  if (game->played_frames == next_perk_frame || (game->played_frames == game->perk_end_frame && game->perk != PERK_NONE)) {
+    return 0;
+  }
+  if (player->perk == PERK_POWER_TIME_STOP) {
+    return limit;
+  }
+  const PlatformStore &platforms = game->platforms;
+  const BoundingBox box = game->box;
+  std::vector<U64> &order = game->sweep_order;
+  const int first_player_line = (player->y - box.min_y) / game->tile_h;
+  const int last_player_line = (player->y + player->h - box.min_y) / game->tile_h;
+  for (U32 line = 0; line < game->lines.get_line_count() && limit > 0; line++) {
+    order.clear();
+    for (const U32 index : game->line_platforms.get(line)) {
+      order.push_back(static_cast<U64>(static_cast<U32>(platforms.x[index]) ^ 0x80000000u) << 32 | index);
+    }
+    std::sort(order.begin(), order.end());
+    const bool player_line = static_cast<int>(line) >= first_player_line && static_cast<int>(line) <= last_player_line;
+    for (size_t i = 0; i < order.size(); i++) {
+      const auto index = static_cast<U32>(order[i]);
+      const S64 x = platforms.x[index];
+      const S64 end = x + platforms.w[index];
+      const S32 speed = platforms.speed[index];
+      /* Fractional speeds do not move a platform by the same amount on every tick, so use the most they can. */
+      const S64 step = get_maximum_platform_step(speed);
+      /* Leaving the box gets a platform repositioned. A platform which does not move is repositioned on every tick. */
+      if (speed == 0 && (end < box.min_x || x > box.max_x)) {
+        limit = 0;
+      } else if (speed > 0) {
+        limit_approach(limit, box.max_x - x, step);
+      } else if (speed < 0) {
+        limit_approach(limit, end - box.min_x, step);
+      }
+      /* Sorted by x, a platform can only run into its neighbors before running into anything else. */
+      if (i + 1 < order.size()) {
+        const auto next = static_cast<U32>(order[i + 1]);
+        const S64 closing = (speed > 0 ? step : 0) + (platforms.speed[next] < 0 ? get_maximum_platform_step(platforms.speed[next]) : 0);
+        limit_approach(limit, platforms.x[next] - end, closing);
+      }
+      if (player_line) {
+        if (end <= player->x) {
+          limit_approach(limit, player->x - end, speed > 0 ? step : 0);
+        } else {
+          limit_approach(limit, x - (player->x + player->w), speed < 0 ? step : 0);
+        }
+      }
+    }
+  }
+  return limit;
+}
+
+U64 fast_forward(Game *const game, const U64 limit) {
+  game->profiler->start("fast_forward");
+  const U64 ticks = count_quiet_ticks(game, limit);
+  if (ticks > 0) {
+    if (game->player->perk != PERK_POWER_TIME_STOP) {
+      for (size_t i = 0; i < game->platform_count; i++) {
+        const auto distance = static_cast<int>(get_motion(game->current_frame, ticks, game->platforms.speed[i], SUBPIXELS_PER_PIXEL));
+        if (distance != 0) {
+          Platform platform = game->platforms.get(i);
+          slide_platform_on_x(game, &platform, distance);
+          game->platforms.x[i] = platform.x;
         }
       }
     }
+    game->current_frame += ticks;
+    /* The last skipped tick is the last one which could have cleared the message. */
+    if (game->message_end_frame < game->current_frame - 1) {
+      game->message[0] = '\0';
+    }
+    /* The player did not move, so only the last positions of the trail matter. */
+    Player *const player = game->player;
+    for (U64 i = 0; i < std::min<U64>(ticks, player->graphics.get_maximum_size()); i++) {
+      update_player_graphics(game);
+    }
+    update_player_contact(game);
   }
   game->profiler->stop();
+  return ticks;
 }
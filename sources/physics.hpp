@@ -17,15 +17,30 @@ static const int EXTRA_POINTS_AMOUNT = 1000;
  *
  * This algorithm is O(n) with respect to the number of lines.
  */
-int select_random_line_blindly(const std::vector<unsigned char> &lines);
+int select_random_line_blindly(const std::vector<unsigned char> &lines, RandomGenerator &generator);
 
 /**
  * Selects at random one of the lines which are the furthest away from any other occupied line.
  *
  * This algorithm is O(n) with respect to the number of lines.
  */
-int select_random_line_awarely(const std::vector<unsigned char> &lines);
+int select_random_line_awarely(const std::vector<unsigned char> &lines, RandomGenerator &generator);
 
+/**
+ * Moves a platform which left the box to the opposite side of it, on a line chosen by the reposition algorithm.
+ *
+ * The platform is the working copy of the platform with the provided index, which the caller stores back.
+ */
+void reposition_platform(Game *const game, size_t index, Platform *const platform);
+
+/**
+ * Moves a platform horizontally by dx, which must not be zero, updating only the columns it leaves and enters.
+ */
+void slide_platform_on_x(Game *const game, Platform *const p, const int dx);
+
+/**
+ * Moves every platform by its speed, one at a time, except while time is stopped.
+ */
 void update_platforms(Game *const game);
 
 void update_perk(Game *const game);
@@ -34,6 +49,15 @@ void update_player(Game *game, Player *player);
 
 void reposition_player(Game *const game);
 
+/**
+ * Skips the next ticks, up to limit, on which nothing but the platform positions and the frame counter would change.
+ *
+ * The caller must make sure that no command is given on these ticks. The platforms are moved straight to where the
+ * skipped ticks would have left them, so the game ends up exactly as if the ticks had been run. Returns how many ticks
+ * were skipped, which is 0 if the next tick is not certain to be quiet.
+ */
+U64 fast_forward(Game *const game, U64 limit);
+
 /**
  * Conceives a bonus perk to the player.
  */
@@ -1,45 +1,84 @@
 #include "platform.hpp"
 #include "data.hpp"
+#include "line_occupancy.hpp"
 #include "logger.hpp"
 #include "physics.hpp"
 #include <cstring>
 
-std::vector<Platform> generate_platforms(const Settings &settings, BoundingBox box, BoundingBox avoidance, U64 count, S32 width, S32 height) {
+std::vector<Platform> generate_platforms(const Settings &settings, BoundingBox box, BoundingBox avoidance, U64 count, S32 width, S32 height,
+                                         RandomGenerator &generator) {
   const S32 min_width = settings.get_platform_min_width() * width;
   const S32 max_width = settings.get_platform_max_width() * width;
   const S32 min_speed = settings.get_platform_min_speed();
   const S32 max_speed = settings.get_platform_max_speed();
-  const auto lines = static_cast<U32>((box.max_y - box.min_y + 1) / height);
-  std::vector<U8> density(lines);
-  for (S32 y = avoidance.min_y; y < avoidance.max_y; y++) {
-    density[y / height] = 1;
+  LineOccupancy density(static_cast<U32>((box.max_y - box.min_y + 1) / height));
+  if (avoidance.min_y < avoidance.max_y) {
+    for (S32 line = avoidance.min_y / height; line <= (avoidance.max_y - 1) / height; line++) {
+      density.add(static_cast<U32>(line));
+    }
   }
   std::vector<Platform> platforms;
   for (U64 i = 0; i < count; i++) {
     platforms.emplace_back();
     Platform &platform = platforms.back();
     platform.h = height;
-    platform.w = random_integer(min_width, max_width);
+    platform.w = generator.integer(min_width, max_width);
     /* Subtract two to remove the borders. */
     /* Subtract one after this to prevent platform being after the screen. */
-    platform.x = random_integer(0, bounding_box_width(&box)) + box.min_x;
-    const auto random_y = select_random_line_awarely(density);
-    density[random_y]++;
-    platform.y = random_y * height + box.min_y;
+    platform.x = generator.integer(0, bounding_box_width(&box)) + box.min_x;
+    const auto random_y = density.select_awarely(generator);
+    density.add(random_y);
+    platform.y = static_cast<S32>(random_y) * height + box.min_y;
     platform.speed = 0;
-    const auto speed = random_integer(min_speed, max_speed);
+    /* Generated speeds are whole pixels per tick, and only the curses make them fractional. */
+    const auto speed = generator.integer(min_speed, max_speed) * SUBPIXELS_PER_PIXEL;
     /* Make about half the platforms go left and about half go right. */
     /* Make sure that the position is OK to trigger repositioning. */
-    if (random_integer(0, 1) != 0) {
+    if (generator.integer(0, 1) != 0) {
       platform.speed = speed;
     } else {
       platform.speed = -speed;
     }
-    platform.rarity = random_integer(0, 4) / 4.0f;
+    platform.rarity = generator.integer(0, 4) / 4.0f;
   }
   return platforms;
 }
 
+PlatformStore::PlatformStore(const std::vector<Platform> &platforms) {
+  for (const Platform &platform : platforms) {
+    x.push_back(platform.x);
+    y.push_back(platform.y);
+    w.push_back(platform.w);
+    h.push_back(platform.h);
+    speed.push_back(platform.speed);
+    rarity.push_back(platform.rarity);
+  }
+}
+
+Platform PlatformStore::get(const size_t index) const {
+  Platform platform;
+  platform.x = x[index];
+  platform.y = y[index];
+  platform.w = w[index];
+  platform.h = h[index];
+  platform.speed = speed[index];
+  platform.rarity = rarity[index];
+  return platform;
+}
+
+void PlatformStore::set(const size_t index, const Platform &platform) {
+  x[index] = platform.x;
+  y[index] = platform.y;
+  w[index] = platform.w;
+  h[index] = platform.h;
+  speed[index] = platform.speed;
+  rarity[index] = platform.rarity;
+}
+
+size_t PlatformStore::get_memory_usage() const {
+  return (x.capacity() + y.capacity() + w.capacity() + h.capacity() + speed.capacity()) * sizeof(S32) + rarity.capacity() * sizeof(float);
+}
+
 bool Platform::operator==(const Platform &rhs) const {
   return x == rhs.x && y == rhs.y && w == rhs.w && h == rhs.h && speed == rhs.speed && rarity == rhs.rarity;
 }
@@ -3,6 +3,7 @@
 
 #include "box.hpp"
 #include "integers.hpp"
+#include "random.hpp"
 #include "settings.hpp"
 #include <vector>
 
@@ -19,6 +20,41 @@ public:
   bool operator!=(const Platform &rhs) const;
 };
 
-std::vector<Platform> generate_platforms(const Settings &settings, BoundingBox box, BoundingBox avoidance, U64 count, int width, int height);
+/**
+ * The platforms of a game, stored as one array per field.
+ *
+ * Loops which touch a single field of every platform, such as advancing them or changing their speeds, read contiguous
+ * memory and can be vectorized by the compiler. The index of a platform never changes.
+ */
+class PlatformStore {
+public:
+  std::vector<S32> x;
+  std::vector<S32> y;
+  std::vector<S32> w;
+  std::vector<S32> h;
+  std::vector<S32> speed;
+  std::vector<float> rarity;
+
+  PlatformStore() = default;
+
+  explicit PlatformStore(const std::vector<Platform> &platforms);
+
+  inline size_t size() const {
+    return x.size();
+  }
+
+  inline bool empty() const {
+    return x.empty();
+  }
+
+  Platform get(size_t index) const;
+
+  void set(size_t index, const Platform &platform);
+
+  size_t get_memory_usage() const;
+};
+
+std::vector<Platform> generate_platforms(const Settings &settings, BoundingBox box, BoundingBox avoidance, U64 count, int width, int height,
+                                         RandomGenerator &generator);
 
 #endif
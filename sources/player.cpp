@@ -22,6 +22,24 @@ Player::Player(std::string name, CommandTable *table) : name(std::move(name)), t
   perk_end_frame = 0;
 }
 
+PlayerSnapshot Player::snapshot() const {
+  return PlayerSnapshot{x, y, speed_x, speed_y, physics, can_double_jump, remaining_jump_height, lives, score, perk, perk_end_frame};
+}
+
+void Player::restore(const PlayerSnapshot &snapshot) {
+  x = snapshot.x;
+  y = snapshot.y;
+  speed_x = snapshot.speed_x;
+  speed_y = snapshot.speed_y;
+  physics = snapshot.physics;
+  can_double_jump = snapshot.can_double_jump;
+  remaining_jump_height = snapshot.remaining_jump_height;
+  lives = snapshot.lives;
+  score = snapshot.score;
+  perk = snapshot.perk;
+  perk_end_frame = snapshot.perk_end_frame;
+}
+
 void Player::decrement_score(const Score amount) {
   const Score maximum_sub = score - MINIMUM_PLAYER_SCORE;
   if (maximum_sub >= amount) {
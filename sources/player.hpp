@@ -7,6 +7,24 @@
 #include "perk.hpp"
 #include "score.hpp"
 
+/**
+ * The part of a Player which the simulation changes.
+ */
+class PlayerSnapshot {
+public:
+  int x;
+  int y;
+  int speed_x;
+  int speed_y;
+  bool physics;
+  int can_double_jump;
+  int remaining_jump_height;
+  int lives;
+  Score score;
+  Perk perk;
+  U64 perk_end_frame;
+};
+
 class Player {
 public:
   std::string name;
@@ -37,6 +55,13 @@ public:
 
   Player(std::string name, CommandTable *table);
 
+  PlayerSnapshot snapshot() const;
+
+  /**
+   * Restores the simulation state of a snapshot. The trail is not restored, as it only affects drawing.
+   */
+  void restore(const PlayerSnapshot &snapshot);
+
   void increment_score(Score amount);
   void decrement_score(Score amount);
   void increment_score_from_event(float rarity);
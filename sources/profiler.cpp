@@ -71,6 +71,36 @@ void Profiler::stop() {
   hierarchy.pop_back();
 }
 
+void Profiler::count(const std::string &event, U64 amount) {
+  if (!active || amount == 0) {
+    return;
+  }
+  hierarchy.push_back(event);
+  const std::string &event_name = get_component_name();
+  events[event_name] += amount;
+  timings[event_name] += 0.0;
+  hierarchy.pop_back();
+}
+
+bool Profiler::is_active() const {
+  return active;
+}
+
+void Profiler::merge(const Profiler &other) {
+  for (const auto &event : other.events) {
+    events[event.first] += event.second;
+  }
+  for (const auto &timing : other.timings) {
+    timings[timing.first] += timing.second;
+  }
+  for (const auto &maximum : other.maxima) {
+    maxima[maximum.first] = std::max(maxima[maximum.first], maximum.second);
+  }
+  for (const auto &minimum : other.minima) {
+    minima[minimum.first] = std::min(minima[minimum.first], minimum.second);
+  }
+}
+
 static std::string seconds_to_milliseconds_string(double value) {
   return double_to_string(1000.0 * value, 2) + " ms";
 }
@@ -29,6 +29,15 @@ public:
   }
   void start(const std::string &component);
   void stop();
+  /**
+   * Adds an amount of occurrences of an event which is not timed, as a child of the running component.
+   */
+  void count(const std::string &event, U64 amount);
+  bool is_active() const;
+  /**
+   * Adds the events and the timings of another profiler to the ones of this profiler.
+   */
+  void merge(const Profiler &other);
   std::string dump();
 };
 
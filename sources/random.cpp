@@ -11,13 +11,33 @@
 
 static const char *const NAME_FILE_PATH = "data/name.txt";
 
-/* These state variables must be initialized so that they are not all zero. */
-static U64 x;
-static U64 y;
-static U64 z;
-static U64 w;
+static RandomGenerator global_generator;
 
-static U64 xorshift128() {
+/**
+ * Returns the next value of a SplitMix64 sequence, which is used to spread a seed over the whole generator state.
+ */
+static U64 split_mix(U64 &state) {
+  U64 value = (state += 0x9E3779B97F4A7C15ULL);
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+RandomGenerator::RandomGenerator(U64 seed, U64 stream) {
+  /* Mix the stream into the seed so that nearby seeds and streams do not produce overlapping states. */
+  U64 state = seed;
+  state = split_mix(state) ^ stream;
+  x = split_mix(state);
+  y = split_mix(state);
+  z = split_mix(state);
+  w = split_mix(state);
+  /* The state must not be all zero. */
+  if ((x | y | z | w) == 0) {
+    w = 1;
+  }
+}
+
+U64 RandomGenerator::next() {
   U64 t = x;
   t ^= t << 11;
   t ^= t >> 8;
@@ -29,8 +49,12 @@ static U64 xorshift128() {
   return w;
 }
 
+U64 get_time_seed() {
+  return static_cast<U64>(time(nullptr));
+}
+
 void seed_random() {
-  x = static_cast<decltype(x)>(time(nullptr));
+  global_generator = RandomGenerator(get_time_seed());
 }
 
 U64 find_next_power_of_two(U64 number) {
@@ -42,7 +66,7 @@ U64 find_next_power_of_two(U64 number) {
   return result;
 }
 
-S32 random_integer(const S32 minimum, const S32 maximum) {
+S32 RandomGenerator::integer(const S32 minimum, const S32 maximum) {
   if (maximum < minimum) {
     return 0;
   }
@@ -50,7 +74,7 @@ S32 random_integer(const S32 minimum, const S32 maximum) {
   const auto next_power_of_two = find_next_power_of_two(range);
   U64 value;
   do {
-    value = xorshift128() % next_power_of_two;
+    value = next() % next_power_of_two;
   } while (value >= range);
   /*
    * Varies from
@@ -61,6 +85,10 @@ S32 random_integer(const S32 minimum, const S32 maximum) {
   return static_cast<S32>(minimum + value);
 }
 
+S32 random_integer(const S32 minimum, const S32 maximum) {
+  return global_generator.integer(minimum, maximum);
+}
+
 static std::string random_word(const std::string &filename) {
   int read = '\0';
   int chosen_line;
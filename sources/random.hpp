@@ -5,7 +5,39 @@
 #include <string>
 
 /**
- * Seeds the number generator with the current time.
+ * A xorshift128 pseudorandom number generator.
+ *
+ * Each Game owns one of these, so that games never share state and can run on different threads. Generators created
+ * with the same seed and stream always produce the same sequence, while different streams of the same seed produce
+ * independent sequences.
+ */
+class RandomGenerator {
+public:
+  explicit RandomGenerator(U64 seed = 0, U64 stream = 0);
+
+  U64 next();
+
+  /**
+   * Returns a random number in the range [minimum, maximum].
+   */
+  S32 integer(S32 minimum, S32 maximum);
+
+private:
+  U64 x;
+  U64 y;
+  U64 z;
+  U64 w;
+};
+
+/**
+ * Returns a seed derived from the current time.
+ */
+U64 get_time_seed();
+
+/**
+ * Seeds the global number generator with the current time.
+ *
+ * The global generator is only used outside of games, such as for picking player names.
  *
  * This function can safely be called multiple times.
  */
@@ -17,7 +49,7 @@ void seed_random();
 U64 find_next_power_of_two(U64 number);
 
 /**
- * Returns a random number in the range [minimum, maximum].
+ * Returns a random number in the range [minimum, maximum] from the global number generator.
  */
 S32 random_integer(S32 minimum, S32 maximum);
 
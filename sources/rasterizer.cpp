@@ -0,0 +1,232 @@
+#include "rasterizer.hpp"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Bands shorter than this are not worth a thread. */
+static const int minimum_band_height = 32;
+
+static U32 to_pixel(const Color color) {
+  return 0xFF000000u | (static_cast<U32>(color.r) << 16) | (static_cast<U32>(color.g) << 8) | color.b;
+}
+
+/**
+ * Returns the rounded value of (source_term + destination * inverse) / 255, where source_term already has 128 added.
+ */
+static U32 blend_channel(const U32 source_term, const U32 destination, const U32 inverse) {
+  const U32 t = source_term + destination * inverse;
+  return (t + (t >> 8)) >> 8;
+}
+
+/**
+ * Blends a color with the provided alpha over a pixel. The alpha of the color is taken to be 255.
+ */
+static U32 blend_pixel(const U32 pixel, const Color color, const U32 alpha) {
+  const U32 inverse = 255 - alpha;
+  const U32 a = blend_channel(255 * alpha + 128, pixel >> 24, inverse);
+  const U32 r = blend_channel(color.r * alpha + 128, (pixel >> 16) & 0xFF, inverse);
+  const U32 g = blend_channel(color.g * alpha + 128, (pixel >> 8) & 0xFF, inverse);
+  const U32 b = blend_channel(color.b * alpha + 128, pixel & 0xFF, inverse);
+  return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static void fill_span(U32 *span, const int count, const U32 pixel) {
+  int i = 0;
+#ifdef RASTERIZER_SSE2
+  const __m128i packed = _mm_set1_epi32(static_cast<int>(pixel));
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_si128(static_cast<__m128i *>(static_cast<void *>(span + i)), packed);
+  }
+#endif
+  for (; i < count; i++) {
+    span[i] = pixel;
+  }
+}
+
+static void blend_span(U32 *span, const int count, const Color color) {
+  const U32 alpha = color.a;
+  int i = 0;
+#ifdef RASTERIZER_SSE2
+  /* Each pixel is widened to four 16-bit lanes in memory order, which is blue, green, red and alpha. */
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - alpha));
+  const auto b = static_cast<short>(color.b * alpha + 128);
+  const auto g = static_cast<short>(color.g * alpha + 128);
+  const auto r = static_cast<short>(color.r * alpha + 128);
+  const auto a = static_cast<short>(255 * alpha + 128);
+  const __m128i source = _mm_set_epi16(a, r, g, b, a, r, g, b);
+  for (; i + 4 <= count; i += 4) {
+    __m128i *address = static_cast<__m128i *>(static_cast<void *>(span + i));
+    const __m128i pixels = _mm_loadu_si128(address);
+    __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverse), source);
+    __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverse), source);
+    low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+    high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+    _mm_storeu_si128(address, _mm_packus_epi16(low, high));
+  }
+#endif
+  for (; i < count; i++) {
+    span[i] = blend_pixel(span[i], color, alpha);
+  }
+}
+
+Rasterizer::Rasterizer(const int w, const int h, const unsigned band_count, const GlyphAtlas *atlas) : w(w), h(h), band_count(band_count), atlas(atlas) {
+  if (w <= 0 || h <= 0) {
+    throw std::logic_error("The rasterizer size must be positive.");
+  }
+  const auto most_bands = static_cast<unsigned>(std::max(1, h / minimum_band_height));
+  this->band_count = std::max(1u, std::min(band_count, most_bands));
+  bands.resize(this->band_count);
+  for (unsigned i = 0; i < this->band_count; i++) {
+    bands[i].x = 0;
+    bands[i].w = w;
+    bands[i].y = static_cast<int>(static_cast<S64>(h) * i / this->band_count);
+    bands[i].h = static_cast<int>(static_cast<S64>(h) * (i + 1) / this->band_count) - bands[i].y;
+  }
+  errors.resize(this->band_count);
+  try {
+    for (unsigned i = 1; i < this->band_count; i++) {
+      workers.emplace_back(&Rasterizer::run_worker, this, i);
+    }
+  } catch (...) {
+    stop_workers();
+    throw;
+  }
+}
+
+Rasterizer::~Rasterizer() {
+  stop_workers();
+}
+
+void Rasterizer::stop_workers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  frame_started.notify_all();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+void Rasterizer::set_target(void *pixels, const int pitch) {
+  this->pixels = static_cast<U8 *>(pixels);
+  this->pitch = pitch;
+}
+
+U32 *Rasterizer::get_row(const int y) const {
+  return static_cast<U32 *>(static_cast<void *>(pixels + static_cast<size_t>(y) * pitch));
+}
+
+void Rasterizer::run_band(const unsigned band) {
+  try {
+    (*task)(bands[band]);
+  } catch (...) {
+    errors[band] = std::current_exception();
+  }
+}
+
+void Rasterizer::run_worker(const unsigned band) {
+  U64 drawn_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      frame_started.wait(lock, [this, drawn_generation]() { return stopping || generation != drawn_generation; });
+      if (stopping) {
+        return;
+      }
+      drawn_generation = generation;
+    }
+    run_band(band);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      remaining--;
+      if (remaining == 0) {
+        frame_finished.notify_one();
+      }
+    }
+  }
+}
+
+void Rasterizer::for_each_band(const std::function<void(const SDL_Rect &band)> &function) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fill(errors.begin(), errors.end(), nullptr);
+    task = &function;
+    remaining = band_count - 1;
+    generation++;
+  }
+  frame_started.notify_all();
+  /* The calling thread draws the first band. */
+  run_band(0);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    frame_finished.wait(lock, [this]() { return remaining == 0; });
+    task = nullptr;
+  }
+  for (const std::exception_ptr &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void Rasterizer::fill(const SDL_Rect &rectangle, const Color color, const bool blend, const SDL_Rect &band) const {
+  const int x_begin = std::max(rectangle.x, 0);
+  const int x_end = std::min(rectangle.x + rectangle.w, w);
+  const int y_begin = std::max(rectangle.y, band.y);
+  const int y_end = std::min(rectangle.y + rectangle.h, band.y + band.h);
+  if (x_begin >= x_end || (blend && color.a == 0)) {
+    return;
+  }
+  const int count = x_end - x_begin;
+  for (int y = y_begin; y < y_end; y++) {
+    if (blend && color.a != 255) {
+      blend_span(get_row(y) + x_begin, count, color);
+    } else {
+      fill_span(get_row(y) + x_begin, count, to_pixel(color));
+    }
+  }
+}
+
+void Rasterizer::print(const int x, const int y, const char *string, const ColorPair color, const SDL_Rect &band) const {
+  if (atlas == nullptr) {
+    return;
+  }
+  const int glyph_width = atlas->get_glyph_width();
+  const int glyph_height = atlas->get_height();
+  SDL_Rect background{};
+  background.x = x;
+  background.y = y;
+  background.w = atlas->get_width(string);
+  background.h = glyph_height;
+  fill(background, color.background, false, band);
+  const int y_begin = std::max(y, band.y);
+  const int y_end = std::min(y + glyph_height, band.y + band.h);
+  const int pitch = atlas->get_coverage_pitch();
+  int glyph_x = x;
+  for (const char *c = string; *c != '\0'; c++, glyph_x += glyph_width) {
+    const U8 *coverage = atlas->get_coverage(static_cast<unsigned char>(*c));
+    if (coverage == nullptr) {
+      continue;
+    }
+    const int x_begin = std::max(glyph_x, 0);
+    const int x_end = std::min(glyph_x + glyph_width, w);
+    for (int row = y_begin; row < y_end; row++) {
+      const U8 *alphas = coverage + static_cast<size_t>(row - y) * pitch;
+      U32 *span = get_row(row);
+      for (int column = x_begin; column < x_end; column++) {
+        const U8 alpha = alphas[column - glyph_x];
+        if (alpha != 0) {
+          span[column] = blend_pixel(span[column], color.foreground, alpha);
+        }
+      }
+    }
+  }
+}
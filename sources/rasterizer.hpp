@@ -0,0 +1,106 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include "color.hpp"
+#include "glyph_atlas.hpp"
+#include "integers.hpp"
+#include <SDL.h>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Draws rectangles and text into ARGB8888 pixels in memory, without a renderer.
+ *
+ * The target is split into bands of rows which are drawn on their own threads. The threads are started once, with the
+ * rasterizer, and wait for each frame. Every drawing function takes the band it is called for and only writes the rows
+ * in it, so the bands never touch the same pixels. Spans are filled and blended four pixels at a time where SSE2 is
+ * available.
+ *
+ * Blending matches SDL_BLENDMODE_BLEND over an opaque target, which is all a frame of the game needs.
+ */
+class Rasterizer {
+public:
+  /**
+   * Creates a rasterizer for a w by h target, split into up to band_count bands. Throws a std::logic_error if the size
+   * is not positive. The atlas is used to draw text and may be nullptr, in which case only the background of text is
+   * drawn.
+   */
+  Rasterizer(int w, int h, unsigned band_count, const GlyphAtlas *atlas);
+
+  /**
+   * Stops and joins the threads of the bands.
+   */
+  ~Rasterizer();
+
+  Rasterizer(const Rasterizer &) = delete;
+  Rasterizer &operator=(const Rasterizer &) = delete;
+
+  /**
+   * Sets the pixels to draw into, whose rows are pitch bytes apart, as SDL_LockTexture returns them.
+   */
+  void set_target(void *pixels, int pitch);
+
+  inline int get_width() const {
+    return w;
+  }
+
+  inline int get_height() const {
+    return h;
+  }
+
+  inline unsigned get_band_count() const {
+    return band_count;
+  }
+
+  /**
+   * Calls the function once for each band, with the rectangle of the band, on as many threads as there are bands.
+   *
+   * Returns after all bands were drawn. If the function throws, the exception is passed on after every band finished.
+   */
+  void for_each_band(const std::function<void(const SDL_Rect &band)> &function);
+
+  /**
+   * Fills the part of the rectangle which lies in the band. Colors are blended if blend is true.
+   */
+  void fill(const SDL_Rect &rectangle, Color color, bool blend, const SDL_Rect &band) const;
+
+  /**
+   * Draws the part of a string which lies in the band over its background, with its top left corner at (x, y).
+   */
+  void print(int x, int y, const char *string, ColorPair color, const SDL_Rect &band) const;
+
+private:
+  U32 *get_row(int y) const;
+
+  void run_band(unsigned band);
+
+  void run_worker(unsigned band);
+
+  void stop_workers();
+
+  int w;
+  int h;
+  unsigned band_count;
+  const GlyphAtlas *atlas;
+  U8 *pixels = nullptr;
+  int pitch = 0;
+
+  std::vector<SDL_Rect> bands;
+  std::vector<std::exception_ptr> errors;
+  // The first band is drawn by the calling thread, so there is one worker for each of the others.
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable frame_started;
+  std::condition_variable frame_finished;
+  // Guarded by the mutex. Each frame increments the generation, and remaining counts the workers still drawing it.
+  const std::function<void(const SDL_Rect &band)> *task = nullptr;
+  U64 generation = 0;
+  unsigned remaining = 0;
+  bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,332 @@
+#include "render_list.hpp"
+#include <algorithm>
+#include <tuple>
+
+static const int layer_shift = 33;
+static const int blend_shift = 32;
+
+static U64 get_key(const RenderLayer layer, const bool blend, const Color color) {
+  const U64 packed = (static_cast<U64>(color.r) << 24) | (static_cast<U64>(color.g) << 16) | (static_cast<U64>(color.b) << 8) | color.a;
+  return (static_cast<U64>(layer) << layer_shift) | (static_cast<U64>(blend ? 1 : 0) << blend_shift) | packed;
+}
+
+static RenderLayer get_layer(const U64 key) {
+  return static_cast<RenderLayer>(key >> layer_shift);
+}
+
+static bool is_blended(const U64 key) {
+  return ((key >> blend_shift) & 1) != 0;
+}
+
+static Color get_color(const U64 key) {
+  return Color(static_cast<U8>(key >> 24), static_cast<U8>(key >> 16), static_cast<U8>(key >> 8), static_cast<U8>(key));
+}
+
+static bool is_empty(const SDL_Rect &r) {
+  return r.w <= 0 || r.h <= 0;
+}
+
+static bool intersect(const SDL_Rect &a, const SDL_Rect &b, SDL_Rect *result) {
+  const int x = std::max(a.x, b.x);
+  const int y = std::max(a.y, b.y);
+  result->w = std::min(a.x + a.w, b.x + b.w) - x;
+  result->h = std::min(a.y + a.h, b.y + b.h) - y;
+  result->x = x;
+  result->y = y;
+  return !is_empty(*result);
+}
+
+static void add_dirty(std::vector<SDL_Rect> &dirty, const int x, const int y, const int w, const int h) {
+  SDL_Rect rectangle{};
+  rectangle.x = x;
+  rectangle.y = y;
+  rectangle.w = w;
+  rectangle.h = h;
+  if (!is_empty(rectangle)) {
+    dirty.push_back(rectangle);
+  }
+}
+
+/**
+ * Maps an edge from a source of source_size pixels starting at source_origin to a target of size pixels, rounding to
+ * the nearest pixel. Edges a whole number of target pixels apart stay that far apart.
+ */
+static int scale_edge(const int edge, const int source_origin, const int source_size, const int size) {
+  const S64 numerator = 2 * static_cast<S64>(edge - source_origin) * size + source_size;
+  const S64 denominator = 2 * static_cast<S64>(source_size);
+  S64 quotient = numerator / denominator;
+  if (numerator % denominator != 0 && numerator < 0) {
+    quotient--;
+  }
+  return static_cast<int>(quotient);
+}
+
+static bool equals(const Color &a, const Color &b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+void RenderList::clear() {
+  rectangles.clear();
+  text_count = 0;
+}
+
+void RenderList::add(const RenderLayer layer, const int x, const int y, const int w, const int h, const Color color, const bool blend) {
+  RectangleCommand command{};
+  command.key = get_key(layer, blend, color);
+  command.rectangle.x = x;
+  command.rectangle.y = y;
+  command.rectangle.w = w;
+  command.rectangle.h = h;
+  rectangles.push_back(command);
+}
+
+void RenderList::add_rectangle(const RenderLayer layer, const int x, const int y, const int w, const int h, const Color color) {
+  add(layer, x, y, w, h, color, color.a != 255);
+}
+
+void RenderList::add_blended_rectangle(const RenderLayer layer, const int x, const int y, const int w, const int h, const Color color) {
+  add(layer, x, y, w, h, color, true);
+}
+
+void RenderList::add_text(const TextCommand &source) {
+  /* Reuse the strings of the previous frames, which are usually about as long. */
+  if (text_count == texts.size()) {
+    texts.emplace_back();
+  }
+  TextCommand &command = texts[text_count++];
+  command.layer = source.layer;
+  command.rectangle = source.rectangle;
+  command.text.assign(source.text);
+  command.color = source.color;
+}
+
+void RenderList::add_text(const RenderLayer layer, const int x, const int y, const int w, const int h, const std::string &text, const ColorPair color) {
+  if (text_count == texts.size()) {
+    texts.emplace_back();
+  }
+  TextCommand &command = texts[text_count++];
+  command.layer = layer;
+  command.rectangle.x = x;
+  command.rectangle.y = y;
+  command.rectangle.w = w;
+  command.rectangle.h = h;
+  command.text.assign(text);
+  command.color = color;
+}
+
+/*
+ * Rectangles of the same state are ordered by row, size and column, so that a rectangle which moved along its row is
+ * next to where it was. Reordering rectangles of the same state does not change the frame, as even blending the same
+ * color with the same opacity gives the same result in any order.
+ */
+static bool rectangle_less(const U64 a_key, const SDL_Rect &a, const U64 b_key, const SDL_Rect &b) {
+  return std::tie(a_key, a.y, a.h, a.w, a.x) < std::tie(b_key, b.y, b.h, b.w, b.x);
+}
+
+void RenderList::sort() {
+  const auto by_state = [](const RectangleCommand &a, const RectangleCommand &b) { return rectangle_less(a.key, a.rectangle, b.key, b.rectangle); };
+  const auto by_layer = [](const TextCommand &a, const TextCommand &b) {
+    return std::tie(a.layer, a.rectangle.y, a.rectangle.x, a.text) < std::tie(b.layer, b.rectangle.y, b.rectangle.x, b.text);
+  };
+  std::sort(rectangles.begin(), rectangles.end(), by_state);
+  std::sort(texts.begin(), texts.begin() + text_count, by_layer);
+}
+
+void RenderList::find_differences(const RenderList &previous, std::vector<SDL_Rect> &dirty) const {
+  /* Walk both sorted lists together, pairing the rectangles which only moved along their rows. */
+  const auto &before = previous.rectangles;
+  const auto &after = rectangles;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < before.size() || j < after.size()) {
+    if (j == after.size() || (i < before.size() && rectangle_less(before[i].key, before[i].rectangle, after[j].key, after[j].rectangle))) {
+      const SDL_Rect &a = before[i].rectangle;
+      const bool same_row = j < after.size() && before[i].key == after[j].key && a.y == after[j].rectangle.y && a.h == after[j].rectangle.h && a.w == after[j].rectangle.w;
+      if (same_row) {
+        const SDL_Rect &b = after[j].rectangle;
+        const int left = std::min(a.x, b.x);
+        const int right = std::max(a.x, b.x);
+        if (right - left < a.w) {
+          add_dirty(dirty, left, a.y, right - left, a.h);
+          add_dirty(dirty, left + a.w, a.y, right - left, a.h);
+        } else {
+          add_dirty(dirty, a.x, a.y, a.w, a.h);
+          add_dirty(dirty, b.x, b.y, b.w, b.h);
+        }
+        i++;
+        j++;
+      } else {
+        add_dirty(dirty, a.x, a.y, a.w, a.h);
+        i++;
+      }
+    } else if (i == before.size() || rectangle_less(after[j].key, after[j].rectangle, before[i].key, before[i].rectangle)) {
+      const SDL_Rect &b = after[j].rectangle;
+      add_dirty(dirty, b.x, b.y, b.w, b.h);
+      j++;
+    } else {
+      i++;
+      j++;
+    }
+  }
+  /* There are only a few strings, so compare them all. */
+  const auto same_text = [](const TextCommand &a, const TextCommand &b) {
+    const SDL_Rect &r = a.rectangle;
+    const SDL_Rect &s = b.rectangle;
+    const bool same_rectangle = r.x == s.x && r.y == s.y && r.w == s.w && r.h == s.h;
+    const bool same_color = equals(a.color.foreground, b.color.foreground) && equals(a.color.background, b.color.background);
+    return a.layer == b.layer && same_rectangle && same_color && a.text == b.text;
+  };
+  for (size_t k = 0; k < previous.text_count; k++) {
+    const TextCommand &text = previous.texts[k];
+    if (std::none_of(texts.begin(), texts.begin() + text_count, [&](const TextCommand &other) { return same_text(text, other); })) {
+      dirty.push_back(text.rectangle);
+    }
+  }
+  for (size_t k = 0; k < text_count; k++) {
+    const TextCommand &text = texts[k];
+    if (std::none_of(previous.texts.begin(), previous.texts.begin() + previous.text_count, [&](const TextCommand &other) { return same_text(text, other); })) {
+      dirty.push_back(text.rectangle);
+    }
+  }
+}
+
+void RenderList::add_clipped(const RenderList &source, const std::vector<SDL_Rect> &regions, const Color background) {
+  SDL_Rect part{};
+  for (const SDL_Rect &region : regions) {
+    add(RENDER_LAYER_BACKGROUND, region.x, region.y, region.w, region.h, background, false);
+    for (const RectangleCommand &command : source.rectangles) {
+      if (intersect(command.rectangle, region, &part)) {
+        rectangles.push_back(command);
+        rectangles.back().rectangle = part;
+      }
+    }
+  }
+  for (size_t k = 0; k < source.text_count; k++) {
+    for (const SDL_Rect &region : regions) {
+      if (intersect(source.texts[k].rectangle, region, &part)) {
+        add_text(source.texts[k]);
+        break;
+      }
+    }
+  }
+}
+
+void RenderList::scale_to(const SDL_Rect &source, const int w, const int h) {
+  size_t kept = 0;
+  for (const RectangleCommand &command : rectangles) {
+    const SDL_Rect &r = command.rectangle;
+    const int left = scale_edge(r.x, source.x, source.w, w);
+    const int top = scale_edge(r.y, source.y, source.h, h);
+    SDL_Rect scaled{};
+    scaled.x = left;
+    scaled.y = top;
+    scaled.w = scale_edge(r.x + r.w, source.x, source.w, w) - left;
+    scaled.h = scale_edge(r.y + r.h, source.y, source.h, h) - top;
+    if (!is_empty(scaled)) {
+      rectangles[kept] = command;
+      rectangles[kept].rectangle = scaled;
+      kept++;
+    }
+  }
+  rectangles.resize(kept);
+  for (size_t k = 0; k < text_count; k++) {
+    SDL_Rect &r = texts[k].rectangle;
+    r.x = scale_edge(r.x, source.x, source.w, w);
+    r.y = scale_edge(r.y, source.y, source.h, h);
+  }
+}
+
+RenderListStatistics RenderList::submit(SDL_Renderer *renderer, TextDrawer draw_text) {
+  RenderListStatistics statistics;
+  statistics.rectangles = rectangles.size();
+  statistics.texts = text_count;
+  sort();
+  SDL_BlendMode initial_blend_mode = SDL_BLENDMODE_NONE;
+  Uint8 r = 0;
+  Uint8 g = 0;
+  Uint8 b = 0;
+  Uint8 a = 0;
+  SDL_GetRenderDrawBlendMode(renderer, &initial_blend_mode);
+  SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+  SDL_BlendMode blend_mode = initial_blend_mode;
+  size_t i = 0;
+  size_t t = 0;
+  for (int layer = 0; layer < RENDER_LAYER_COUNT; layer++) {
+    while (i < rectangles.size() && get_layer(rectangles[i].key) == layer) {
+      const U64 key = rectangles[i].key;
+      batch.clear();
+      while (i < rectangles.size() && rectangles[i].key == key) {
+        batch.push_back(rectangles[i].rectangle);
+        i++;
+      }
+      const SDL_BlendMode key_blend_mode = is_blended(key) ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE;
+      if (key_blend_mode != blend_mode) {
+        blend_mode = key_blend_mode;
+        SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+      }
+      const Color color = get_color(key);
+      SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+      SDL_RenderFillRects(renderer, batch.data(), static_cast<int>(batch.size()));
+      statistics.draw_calls++;
+    }
+    while (t < text_count && texts[t].layer == layer) {
+      draw_text(texts[t].rectangle.x, texts[t].rectangle.y, texts[t].text.c_str(), texts[t].color, renderer);
+      statistics.draw_calls++;
+      t++;
+    }
+  }
+  SDL_SetRenderDrawColor(renderer, r, g, b, a);
+  SDL_SetRenderDrawBlendMode(renderer, initial_blend_mode);
+  return statistics;
+}
+
+RenderListStatistics RenderList::submit(Rasterizer &rasterizer, const Color background) {
+  RenderListStatistics statistics;
+  statistics.rectangles = rectangles.size();
+  statistics.texts = text_count;
+  sort();
+  rasterizer.for_each_band([this, &rasterizer, background](const SDL_Rect &band) {
+    rasterizer.fill(band, background, false, band);
+    size_t i = 0;
+    size_t t = 0;
+    for (int layer = 0; layer < RENDER_LAYER_COUNT; layer++) {
+      for (; i < rectangles.size() && get_layer(rectangles[i].key) == layer; i++) {
+        rasterizer.fill(rectangles[i].rectangle, get_color(rectangles[i].key), is_blended(rectangles[i].key), band);
+      }
+      for (; t < text_count && texts[t].layer == layer; t++) {
+        rasterizer.print(texts[t].rectangle.x, texts[t].rectangle.y, texts[t].text.c_str(), texts[t].color, band);
+      }
+    }
+  });
+  return statistics;
+}
+
+static bool overlap(const SDL_Rect &a, const SDL_Rect &b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void merge_overlapping_rectangles(std::vector<SDL_Rect> &rectangles) {
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (size_t i = 0; i < rectangles.size(); i++) {
+      for (size_t j = i + 1; j < rectangles.size();) {
+        if (overlap(rectangles[i], rectangles[j])) {
+          SDL_Rect &a = rectangles[i];
+          const SDL_Rect &b = rectangles[j];
+          const int right = std::max(a.x + a.w, b.x + b.w);
+          const int bottom = std::max(a.y + a.h, b.y + b.h);
+          a.x = std::min(a.x, b.x);
+          a.y = std::min(a.y, b.y);
+          a.w = right - a.x;
+          a.h = bottom - a.y;
+          rectangles[j] = rectangles.back();
+          rectangles.pop_back();
+          merged = true;
+        } else {
+          j++;
+        }
+      }
+    }
+  }
+}
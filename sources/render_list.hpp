@@ -0,0 +1,137 @@
+#ifndef RENDER_LIST_H
+#define RENDER_LIST_H
+
+#include "color.hpp"
+#include "integers.hpp"
+#include "rasterizer.hpp"
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+/**
+ * The layers of a frame, from the bottom to the top.
+ *
+ * Commands on a lower layer are drawn first. Within a layer, commands are reordered to group those with the same state,
+ * so the shapes of a layer must not overlap unless they have the same color.
+ */
+enum RenderLayer {
+  RENDER_LAYER_BACKGROUND,
+  RENDER_LAYER_BARS,
+  RENDER_LAYER_PLATFORMS,
+  RENDER_LAYER_PERK_BACKGROUND,
+  RENDER_LAYER_PERK,
+  RENDER_LAYER_PLAYER,
+  RENDER_LAYER_TRAIL,
+  RENDER_LAYER_COUNT
+};
+
+/**
+ * How many commands a RenderList held and how many calls to the renderer drawing them took.
+ */
+class RenderListStatistics {
+public:
+  U64 rectangles = 0;
+  U64 texts = 0;
+  U64 draw_calls = 0;
+};
+
+/**
+ * The rectangles and the text of a frame, recorded in any order and drawn sorted by layer and state.
+ *
+ * Rectangles of a layer which share a blend mode and a color are drawn with a single SDL_RenderFillRects call, and the
+ * draw color and blend mode are only set when they change. Text is drawn after the rectangles of its layer.
+ */
+class RenderList {
+public:
+  typedef void (*TextDrawer)(int x, int y, const char *string, ColorPair color, SDL_Renderer *renderer);
+
+  /**
+   * Removes all commands, keeping the memory for the next frame.
+   */
+  void clear();
+
+  /**
+   * Adds a filled rectangle. Colors which are not opaque are blended with what is below them.
+   */
+  void add_rectangle(RenderLayer layer, int x, int y, int w, int h, Color color);
+
+  /**
+   * Adds a filled rectangle which is always blended with what is below it.
+   */
+  void add_blended_rectangle(RenderLayer layer, int x, int y, int w, int h, Color color);
+
+  /**
+   * Adds a string, which covers the w by h rectangle at (x, y) with its background.
+   */
+  void add_text(RenderLayer layer, int x, int y, int w, int h, const std::string &text, ColorPair color);
+
+  /**
+   * Sorts the commands by layer and state, and then by position. Comparing two frames requires both to be sorted.
+   */
+  void sort();
+
+  /**
+   * Adds to dirty the regions where this frame differs from the previous one. Both lists must be sorted.
+   *
+   * A rectangle which moved along its row only dirties its leading and trailing edges.
+   */
+  void find_differences(const RenderList &previous, std::vector<SDL_Rect> &dirty) const;
+
+  /**
+   * Adds the parts of the commands of the source which lie in the regions, over a fill of each region with the
+   * background color. The regions must not overlap.
+   *
+   * Text is added whole if it touches a region, because drawing a string over itself leaves it unchanged.
+   */
+  void add_clipped(const RenderList &source, const std::vector<SDL_Rect> &regions, Color background);
+
+  /**
+   * Maps the commands from the source rectangle to a w by h rectangle at the origin, rounding each edge to the nearest
+   * pixel. Rectangles which become empty are removed. Text keeps its size and is only moved.
+   */
+  void scale_to(const SDL_Rect &source, int w, int h);
+
+  /**
+   * Draws all commands. The draw color and blend mode of the renderer are restored afterwards.
+   */
+  RenderListStatistics submit(SDL_Renderer *renderer, TextDrawer draw_text);
+
+  /**
+   * Draws all commands over the background color with a rasterizer, every band on its own thread.
+   *
+   * No calls to a renderer are made, so the statistics count none.
+   */
+  RenderListStatistics submit(Rasterizer &rasterizer, Color background);
+
+private:
+  class RectangleCommand {
+  public:
+    // The layer, the blend mode and the color, in this order of significance.
+    U64 key;
+    SDL_Rect rectangle;
+  };
+
+  class TextCommand {
+  public:
+    RenderLayer layer;
+    SDL_Rect rectangle;
+    std::string text;
+    ColorPair color;
+  };
+
+  void add(RenderLayer layer, int x, int y, int w, int h, Color color, bool blend);
+
+  void add_text(const TextCommand &command);
+
+  std::vector<RectangleCommand> rectangles;
+  std::vector<TextCommand> texts;
+  size_t text_count = 0;
+  std::vector<SDL_Rect> batch;
+};
+
+/**
+ * Merges the rectangles which overlap into their bounding boxes, until no two rectangles overlap.
+ */
+void merge_overlapping_rectangles(std::vector<SDL_Rect> &rectangles);
+
+#endif
@@ -0,0 +1,100 @@
+#include "render_snapshot.hpp"
+#include <algorithm>
+
+int get_view_width(const Settings &settings) {
+  return settings.get_window_width();
+}
+
+int get_view_height(const Settings &settings) {
+  return settings.get_window_height() - 2 * settings.get_bar_height();
+}
+
+Point get_view_origin(const Game &game) {
+  const Settings &settings = *game.settings;
+  const Player *const player = game.player;
+  const int max_x = static_cast<int>(settings.get_playfield_width()) - get_view_width(settings);
+  const int max_y = static_cast<int>(settings.get_playfield_height()) - get_view_height(settings);
+  const int x = player->x + player->w / 2 - get_view_width(settings) / 2;
+  const int y = player->y + player->h / 2 - get_view_height(settings) / 2;
+  return Point(std::max(0, std::min(max_x, x)), std::max(0, std::min(max_y, y)));
+}
+
+/**
+ * Copies the platforms in view.
+ *
+ * Only the lines in view are visited, so the platforms above and below the view cost nothing to skip.
+ */
+static void capture_platforms(const Game &game, RenderSnapshot &snapshot) {
+  snapshot.platforms.clear();
+  snapshot.platform_indices.clear();
+  const int min_x = std::max(game.box.min_x, snapshot.origin.x);
+  const int max_x = std::min(game.box.max_x, snapshot.origin.x + snapshot.view_width - 1);
+  const int first_line = snapshot.origin.y / game.tile_h;
+  const int last_line = std::min(static_cast<int>(game.lines.get_line_count()) - 1, (snapshot.origin.y + snapshot.view_height - 1) / game.tile_h);
+  for (int line = first_line; line <= last_line; line++) {
+    for (const U32 i : game.line_platforms.get(static_cast<U32>(line))) {
+      if (game.platforms.x[i] <= max_x && game.platforms.x[i] + game.platforms.w[i] > min_x) {
+        snapshot.platforms.push_back(game.platforms.get(i));
+        snapshot.platform_indices.push_back(i);
+      }
+    }
+  }
+}
+
+/**
+ * Copies the rows of the view whose version changed since this snapshot last copied them.
+ */
+static void capture_collider(const Game &game, RenderSnapshot &snapshot) {
+  const auto w = static_cast<size_t>(snapshot.view_width);
+  const auto h = static_cast<size_t>(snapshot.view_height);
+  const bool moved = snapshot.collider_origin.x != snapshot.origin.x || snapshot.collider_origin.y != snapshot.origin.y;
+  if (moved || snapshot.collider.size() != w * h) {
+    snapshot.collider.resize(w * h);
+    snapshot.collider_versions.assign(h, 0);
+    snapshot.collider_origin = snapshot.origin;
+  }
+  for (size_t row = 0; row < h; row++) {
+    const int y = snapshot.origin.y + static_cast<int>(row);
+    const U64 version = game.collider.get_row_version(y);
+    if (snapshot.collider_versions[row] == version) {
+      continue;
+    }
+    U8 *pixels = snapshot.collider.data() + row * w;
+    for (size_t column = 0; column < w; column++) {
+      pixels[column] = get_from_rigid_matrix(&game, snapshot.origin.x + static_cast<int>(column), y);
+    }
+    snapshot.collider_versions[row] = version;
+  }
+}
+
+void RenderSnapshot::capture(const Game &game, const bool debugging) {
+  const Settings &settings = *game.settings;
+  const Player &player = *game.player;
+  frame = game.current_frame;
+  origin = get_view_origin(game);
+  view_width = get_view_width(settings);
+  view_height = get_view_height(settings);
+  capture_platforms(game, *this);
+  this->player = Point(player.x, player.y);
+  trail.assign(player.graphics.trail.begin(), player.graphics.trail.end());
+  trail_size = player.graphics.get_maximum_size();
+  player_perk = player.perk;
+  lives = player.lives;
+  score = player.score;
+  perk = game.perk;
+  perk_x = game.perk_x;
+  perk_y = game.perk_y;
+  perk_end_frame = game.perk_end_frame;
+  played_frames = game.played_frames;
+  limit_played_frames = game.limit_played_frames;
+  message = game.message;
+  this->debugging = debugging;
+  if (debugging) {
+    capture_collider(game, *this);
+  }
+  finished = is_game_over(game);
+}
+
+bool is_game_over(const Game &game) {
+  return game.player->lives == 0 || game.played_frames >= game.limit_played_frames;
+}
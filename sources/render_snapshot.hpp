@@ -0,0 +1,93 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include "clock.hpp"
+#include "game.hpp"
+#include "integers.hpp"
+#include "perk.hpp"
+#include "platform.hpp"
+#include "point.hpp"
+#include "score.hpp"
+#include "settings.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * Everything that drawing a game needs, copied from the game at the end of a tick.
+ *
+ * The simulation thread captures these and the main thread draws them, so drawing never reads the game itself. Only
+ * the platforms in view are copied, so capturing does not grow with the size of the playfield.
+ */
+class RenderSnapshot {
+public:
+  // The tick after which this was captured.
+  U64 frame = 0;
+  // When that tick was due, as returned by get_milliseconds(). Capturing does not set this, the simulation does.
+  Milliseconds time = 0;
+
+  // The point of the playfield drawn at the top left corner of the area between the bars, and the size of that area.
+  Point origin;
+  int view_width = 0;
+  int view_height = 0;
+
+  // The platforms on the lines in view, in playfield coordinates, and their indices in the platform store.
+  std::vector<Platform> platforms;
+  std::vector<U32> platform_indices;
+
+  Point player;
+  // The trail of the player, from its oldest position, and how many positions it holds at most.
+  std::vector<Point> trail;
+  size_t trail_size = 0;
+  Perk player_perk = PERK_NONE;
+  int lives = 0;
+  Score score = 0;
+
+  Perk perk = PERK_NONE;
+  int perk_x = 0;
+  int perk_y = 0;
+  U64 perk_end_frame = 0;
+  U64 played_frames = 0;
+  U64 limit_played_frames = 0;
+
+  std::string message;
+
+  // Whether each pixel of the view is occupied by the collider, row by row, as of the last capture while debugging.
+  // The rows are tagged with the collider versions they were copied at, so only the rows which changed are copied again
+  // and only those need to be drawn again.
+  bool debugging = false;
+  Point collider_origin;
+  std::vector<U8> collider;
+  std::vector<U64> collider_versions;
+
+  // Whether the game ended on this tick.
+  bool finished = false;
+
+  /**
+   * Copies the state of the game, reusing the memory of the previous capture.
+   */
+  void capture(const Game &game, bool debugging);
+};
+
+/**
+ * Returns the width of the area between the bars, where the playfield is drawn.
+ */
+int get_view_width(const Settings &settings);
+
+/**
+ * Returns the height of the area between the bars, where the playfield is drawn.
+ */
+int get_view_height(const Settings &settings);
+
+/**
+ * Returns the point of the playfield which is drawn at the top left corner of the area between the bars.
+ *
+ * When the playfield is larger than the window, the view follows the player without leaving the playfield.
+ */
+Point get_view_origin(const Game &game);
+
+/**
+ * Evaluates whether or not the game is over, because the player ran out of lives or of time.
+ */
+bool is_game_over(const Game &game);
+
+#endif
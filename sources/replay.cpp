@@ -0,0 +1,204 @@
+#include "replay.hpp"
+#include "clock.hpp"
+#include "physics.hpp"
+#include "profiler.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+const char *const replay_filename = "replay.bin";
+
+static const char replay_magic[4] = {'W', 'O', 'D', 'R'};
+static const U32 replay_version = 2;
+
+/**
+ * The commands which process_command reads. No other command changes the simulation.
+ */
+static const Command replayed_commands[] = {COMMAND_LEFT, COMMAND_RIGHT, COMMAND_JUMP, COMMAND_CONVERT};
+
+static const U32 fnv_offset_basis = 2166136261u;
+static const U32 fnv_prime = 16777619u;
+
+static void hash_value(U32 &hash, const S64 value) {
+  for (int i = 0; i < 8; i++) {
+    hash ^= static_cast<U8>(static_cast<U64>(value) >> (8 * i));
+    hash *= fnv_prime;
+  }
+}
+
+U32 hash_game_state(const Game &game) {
+  U32 hash = fnv_offset_basis;
+  const Player &player = *game.player;
+  hash_value(hash, player.x);
+  hash_value(hash, player.y);
+  hash_value(hash, player.speed_x);
+  hash_value(hash, player.speed_y);
+  hash_value(hash, player.physics);
+  hash_value(hash, player.can_double_jump);
+  hash_value(hash, player.remaining_jump_height);
+  hash_value(hash, player.lives);
+  hash_value(hash, player.score);
+  hash_value(hash, player.perk);
+  hash_value(hash, static_cast<S64>(player.perk_end_frame));
+  hash_value(hash, static_cast<S64>(game.played_frames));
+  hash_value(hash, game.perk);
+  hash_value(hash, game.perk_x);
+  hash_value(hash, game.perk_y);
+  hash_value(hash, static_cast<S64>(game.perk_end_frame));
+  for (size_t i = 0; i < game.platforms.size(); i++) {
+    hash_value(hash, game.platforms.x[i]);
+    hash_value(hash, game.platforms.y[i]);
+    hash_value(hash, game.platforms.w[i]);
+    hash_value(hash, game.platforms.speed[i]);
+  }
+  return hash;
+}
+
+template <typename T> static void write_value(std::ofstream &stream, const T value) {
+  stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> static T read_value(std::ifstream &stream) {
+  T value;
+  if (!stream.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw std::runtime_error("Replay file is truncated.");
+  }
+  return value;
+}
+
+void Replay::save(const std::string &filename) const {
+  std::ofstream stream(filename, std::ios::binary);
+  stream.write(replay_magic, sizeof(replay_magic));
+  write_value(stream, replay_version);
+  write_value(stream, seed);
+  write_value(stream, display_width);
+  write_value(stream, display_height);
+  write_value(stream, static_cast<U32>(settings.size()));
+  stream.write(settings.data(), settings.size());
+  write_value(stream, static_cast<U64>(changes.size()));
+  U64 previous_tick = 0;
+  for (const ReplayChange &change : changes) {
+    /* Changes are sparse, so the distance to the previous one is smaller than the tick itself. */
+    write_value(stream, static_cast<U32>(change.tick - previous_tick));
+    write_value(stream, static_cast<U8>(change.command));
+    write_value(stream, change.status);
+    previous_tick = change.tick;
+  }
+  write_value(stream, static_cast<U64>(hashes.size()));
+  for (const U32 hash : hashes) {
+    write_value(stream, hash);
+  }
+  if (!stream) {
+    throw std::runtime_error("Could not write the replay to " + filename + ".");
+  }
+}
+
+Replay Replay::load(const std::string &filename) {
+  std::ifstream stream(filename, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("Could not read " + filename + ".");
+  }
+  char magic[sizeof(replay_magic)];
+  if (!stream.read(magic, sizeof(magic)) || std::memcmp(magic, replay_magic, sizeof(magic)) != 0) {
+    throw std::runtime_error(filename + " is not a replay.");
+  }
+  if (read_value<U32>(stream) != replay_version) {
+    throw std::runtime_error(filename + " has an unsupported replay version.");
+  }
+  Replay replay;
+  replay.seed = read_value<U64>(stream);
+  replay.display_width = read_value<U32>(stream);
+  replay.display_height = read_value<U32>(stream);
+  replay.settings.resize(read_value<U32>(stream));
+  if (!stream.read(&replay.settings[0], replay.settings.size())) {
+    throw std::runtime_error("Replay file is truncated.");
+  }
+  const auto change_count = read_value<U64>(stream);
+  U64 tick = 0;
+  for (U64 i = 0; i < change_count; i++) {
+    ReplayChange change{};
+    tick += read_value<U32>(stream);
+    change.tick = tick;
+    const auto command = read_value<U8>(stream);
+    if (command >= COMMAND_COUNT) {
+      throw std::runtime_error(filename + " has an invalid command.");
+    }
+    change.command = static_cast<Command>(command);
+    change.status = read_value<F64>(stream);
+    replay.changes.push_back(change);
+  }
+  const auto hash_count = read_value<U64>(stream);
+  for (U64 i = 0; i < hash_count; i++) {
+    replay.hashes.push_back(read_value<U32>(stream));
+  }
+  return replay;
+}
+
+ReplayRecorder::ReplayRecorder(const Game &game) {
+  replay.seed = game.seed;
+  replay.display_width = game.settings->get_display_width();
+  replay.display_height = game.settings->get_display_height();
+  replay.settings = game.settings->get_text();
+}
+
+void ReplayRecorder::record_commands(const Game &game) {
+  const U64 tick = replay.hashes.size();
+  for (const Command command : replayed_commands) {
+    const F64 status = game.player->table->status[command];
+    if (status != last_status[command]) {
+      replay.changes.push_back(ReplayChange{tick, command, status});
+      last_status[command] = status;
+    }
+  }
+}
+
+void ReplayRecorder::record_hash(const Game &game) {
+  replay.hashes.push_back(hash_game_state(game));
+}
+
+PlaybackResult play_replay(const Replay &replay, const bool real_time) {
+  Settings settings;
+  settings.load(replay.settings.c_str());
+  settings.compute_window_size(replay.display_width, replay.display_height);
+  CommandTable table{};
+  initialize_command_table(&table);
+  Player player("Replay", &table);
+  Profiler profiler(false);
+  Game game(&player, &settings, &profiler, replay.seed);
+  /* The status of each command as of the last change, which is written again on every tick. */
+  F64 status[COMMAND_COUNT]{};
+  auto change = replay.changes.begin();
+  PlaybackResult result;
+  const Milliseconds logic_interval = 1000 / UPS;
+  const Milliseconds playback_start = get_milliseconds();
+  const auto start = std::chrono::steady_clock::now();
+  for (U64 tick = 0; tick < replay.get_tick_count(); tick++) {
+    for (; change != replay.changes.end() && change->tick == tick; ++change) {
+      status[change->command] = change->status;
+    }
+    for (const Command command : replayed_commands) {
+      table.status[command] = status[command];
+    }
+    update_game(&game);
+    update_player(&game, &player);
+    game.current_frame++;
+    game.desired_frame = game.current_frame;
+    result.ticks++;
+    if (hash_game_state(game) != replay.hashes[tick]) {
+      result.diverged = true;
+      result.divergent_tick = tick;
+      break;
+    }
+    if (real_time) {
+      const Milliseconds due = playback_start + (tick + 1) * logic_interval;
+      const Milliseconds now = get_milliseconds();
+      if (now < due) {
+        sleep_milliseconds(due - now);
+      }
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  return result;
+}
@@ -0,0 +1,91 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "command.hpp"
+#include "game.hpp"
+#include "integers.hpp"
+#include <string>
+#include <vector>
+
+extern const char *const replay_filename;
+
+/**
+ * A command whose status changed at the start of a logic tick.
+ */
+class ReplayChange {
+public:
+  U64 tick;
+  Command command;
+  F64 status;
+};
+
+/**
+ * Everything needed to reproduce a game exactly: its seed, its settings, and the commands the physics consumed.
+ *
+ * A hash of the game state after each tick is kept, so that playback can find where it diverges from the recording.
+ */
+class Replay {
+public:
+  U64 seed = 0;
+  U32 display_width = 0;
+  U32 display_height = 0;
+  std::string settings;
+  std::vector<ReplayChange> changes;
+  std::vector<U32> hashes;
+
+  inline U64 get_tick_count() const {
+    return hashes.size();
+  }
+
+  /**
+   * Writes the replay to a binary file. Throws a std::runtime_error if the file cannot be written.
+   */
+  void save(const std::string &filename) const;
+
+  /**
+   * Reads a replay written by save. Throws a std::runtime_error if the file cannot be read or is not a replay.
+   */
+  static Replay load(const std::string &filename);
+};
+
+/**
+ * Records a game as it runs. Call record_commands before each logic tick and record_hash after it.
+ */
+class ReplayRecorder {
+public:
+  explicit ReplayRecorder(const Game &game);
+
+  void record_commands(const Game &game);
+
+  void record_hash(const Game &game);
+
+  inline const Replay &get_replay() const {
+    return replay;
+  }
+
+private:
+  Replay replay;
+  F64 last_status[COMMAND_COUNT]{};
+};
+
+/**
+ * Returns a hash of the parts of the game state that the simulation changes.
+ */
+U32 hash_game_state(const Game &game);
+
+class PlaybackResult {
+public:
+  U64 ticks = 0;
+  bool diverged = false;
+  U64 divergent_tick = 0;
+  double seconds = 0.0;
+};
+
+/**
+ * Plays a replay back without a renderer, checking the state hash after every tick.
+ *
+ * If real_time is true, ticks are paced to UPS. Otherwise they run as fast as possible.
+ */
+PlaybackResult play_replay(const Replay &replay, bool real_time);
+
+#endif
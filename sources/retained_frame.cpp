@@ -0,0 +1,52 @@
+#include "retained_frame.hpp"
+#include <utility>
+
+RetainedFrame::~RetainedFrame() {
+  if (texture != nullptr) {
+    SDL_DestroyTexture(texture);
+  }
+}
+
+bool RetainedFrame::update(RenderList &frame, const int w, const int h, const Color background, SDL_Renderer *renderer, RenderList::TextDrawer draw_text) {
+  statistics = RenderListStatistics();
+  dirty.clear();
+  if (texture == nullptr || this->w != w || this->h != h) {
+    if (texture != nullptr) {
+      SDL_DestroyTexture(texture);
+    }
+    this->w = w;
+    this->h = h;
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    drawn = false;
+    if (texture == nullptr) {
+      return false;
+    }
+  }
+  frame.sort();
+  if (drawn) {
+    frame.find_differences(previous, dirty);
+    merge_overlapping_rectangles(dirty);
+    if (dirty.empty()) {
+      std::swap(previous, frame);
+      return false;
+    }
+  } else {
+    SDL_Rect whole{};
+    whole.w = w;
+    whole.h = h;
+    dirty.push_back(whole);
+  }
+  clipped.clear();
+  clipped.add_clipped(frame, dirty, background);
+  SDL_Texture *target = SDL_GetRenderTarget(renderer);
+  SDL_SetRenderTarget(renderer, texture);
+  statistics = clipped.submit(renderer, draw_text);
+  SDL_SetRenderTarget(renderer, target);
+  drawn = true;
+  std::swap(previous, frame);
+  return true;
+}
+
+void RetainedFrame::copy(SDL_Renderer *renderer, const SDL_Rect *destination) const {
+  SDL_RenderCopy(renderer, texture, nullptr, destination);
+}
@@ -0,0 +1,71 @@
+#ifndef RETAINED_FRAME_H
+#define RETAINED_FRAME_H
+
+#include "color.hpp"
+#include "integers.hpp"
+#include "render_list.hpp"
+#include <SDL.h>
+#include <vector>
+
+/**
+ * A texture holding the last frame drawn, which is brought up to date by drawing only what changed.
+ *
+ * Each frame is compared with the previous one. The regions where they differ are filled with the background and the
+ * parts of the new frame which lie in them are drawn again, so the bars, the platforms which did not move and the
+ * unchanged text are not drawn at all. A frame without differences changes nothing.
+ *
+ * Requires a renderer which supports render targets.
+ */
+class RetainedFrame {
+public:
+  RetainedFrame() = default;
+
+  ~RetainedFrame();
+
+  RetainedFrame(const RetainedFrame &) = delete;
+  RetainedFrame &operator=(const RetainedFrame &) = delete;
+
+  /**
+   * Draws the differences between the frame and the previous one into the texture, which is w by h pixels. The frame
+   * is sorted and kept for the next comparison, and the list passed in gets the previous frame back.
+   *
+   * Returns whether the texture changed.
+   */
+  bool update(RenderList &frame, int w, int h, Color background, SDL_Renderer *renderer, RenderList::TextDrawer draw_text);
+
+  /**
+   * Evaluates whether or not the texture exists, which it may not if the last update could not create it.
+   */
+  inline bool has_texture() const {
+    return texture != nullptr;
+  }
+
+  /**
+   * Copies the texture to the destination rectangle of the current target of the renderer, or to all of it if the
+   * destination is nullptr.
+   */
+  void copy(SDL_Renderer *renderer, const SDL_Rect *destination) const;
+
+  /**
+   * Returns what drawing the last update took.
+   */
+  inline const RenderListStatistics &get_statistics() const {
+    return statistics;
+  }
+
+  inline U64 get_dirty_rectangles() const {
+    return dirty.size();
+  }
+
+private:
+  SDL_Texture *texture = nullptr;
+  int w = 0;
+  int h = 0;
+  bool drawn = false;
+  RenderList previous;
+  RenderList clipped;
+  std::vector<SDL_Rect> dirty;
+  RenderListStatistics statistics;
+};
+
+#endif
@@ -0,0 +1,292 @@
+#include "rigid_matrix.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#define RIGID_MATRIX_BIT_SCAN
+#include <intrin.h>
+#endif
+
+static const int WORD_BITS = 64;
+
+/**
+ * Returns the index of the lowest set bit of a word, which must not be zero.
+ */
+static int count_trailing_zeros(const U64 word) {
+#if defined(RIGID_MATRIX_BIT_SCAN)
+  unsigned long index;
+  _BitScanForward64(&index, word);
+  return static_cast<int>(index);
+#elif defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  int index = 0;
+  while (((word >> index) & 1) == 0) {
+    index++;
+  }
+  return index;
+#endif
+}
+
+/**
+ * Returns a word with the bits in [begin, end) set.
+ */
+static U64 get_word_mask(const int begin, const int end) {
+  const U64 all = std::numeric_limits<U64>::max();
+  const U64 below_end = end == WORD_BITS ? all : (static_cast<U64>(1) << end) - 1;
+  return below_end & (all << begin);
+}
+
+RigidMatrix::RigidMatrix(BoundingBox box) : box(box) {
+  columns = static_cast<size_t>(box.max_x - box.min_x + 1);
+  const auto rows = static_cast<size_t>(box.max_y - box.min_y + 1);
+  words_per_row = (columns + WORD_BITS - 1) / WORD_BITS;
+  words.resize(words_per_row * rows);
+  row_overlaps.resize(rows);
+  row_counts.resize(rows);
+}
+
+/**
+ * Clips the rectangle to the box and converts it to matrix coordinates.
+ *
+ * Returns false if nothing is left after clipping.
+ */
+bool RigidMatrix::clip(int &x, int &y, int &w, int &h) const {
+  const int min_x = std::max(x, box.min_x);
+  const int min_y = std::max(y, box.min_y);
+  const int max_x = std::min(x + w - 1, box.max_x);
+  const int max_y = std::min(y + h - 1, box.max_y);
+  if (min_x > max_x || min_y > max_y) {
+    return false;
+  }
+  x = min_x - box.min_x;
+  y = min_y - box.min_y;
+  w = max_x - min_x + 1;
+  h = max_y - min_y + 1;
+  return true;
+}
+
+U8 RigidMatrix::get(const int x, const int y) const {
+  if (!box.contains(x, y)) {
+    return 0;
+  }
+  const auto row = static_cast<size_t>(y - box.min_y);
+  const auto column = static_cast<size_t>(x - box.min_x);
+  const U64 word = words[row * words_per_row + column / WORD_BITS];
+  if ((word >> (column % WORD_BITS) & 1u) == 0) {
+    return 0;
+  }
+  if (!row_counts[row].empty()) {
+    return row_counts[row][column];
+  }
+  return 1;
+}
+
+U64 RigidMatrix::get_span_mask(const int x, const int w, const int i) const {
+  const int word_start = i * WORD_BITS;
+  return get_word_mask(std::max(x, word_start) - word_start, std::min(x + w, word_start + WORD_BITS) - word_start);
+}
+
+void RigidMatrix::increment_row(const int x, const int y, const int w) {
+  U64 *row_words = words.data() + static_cast<size_t>(y) * words_per_row;
+  std::vector<U8> &counts = row_counts[y];
+  if (counts.empty()) {
+    bool covered = false;
+    for (int i = x / WORD_BITS; i <= (x + w - 1) / WORD_BITS; i++) {
+      covered = covered || (row_words[i] & get_span_mask(x, w, i)) != 0;
+    }
+    if (!covered) {
+      for (int i = x / WORD_BITS; i <= (x + w - 1) / WORD_BITS; i++) {
+        row_words[i] |= get_span_mask(x, w, i);
+      }
+      return;
+    }
+    /* This is the first overlap of the row, so start counting its cells. */
+    counts.assign(columns, 0);
+    for (size_t i = 0; i < words_per_row; i++) {
+      for (U64 word = row_words[i]; word != 0; word &= word - 1) {
+        counts[i * WORD_BITS + count_trailing_zeros(word)] = 1;
+      }
+    }
+  }
+  if (*std::max_element(counts.begin() + x, counts.begin() + x + w) == std::numeric_limits<U8>::max()) {
+    throw std::logic_error("Overflow.");
+  }
+  for (int column = x; column < x + w; column++) {
+    if (++counts[column] == 2) {
+      row_overlaps[y]++;
+    }
+  }
+  for (int i = x / WORD_BITS; i <= (x + w - 1) / WORD_BITS; i++) {
+    row_words[i] |= get_span_mask(x, w, i);
+  }
+}
+
+void RigidMatrix::decrement_row(const int x, const int y, const int w) {
+  U64 *row_words = words.data() + static_cast<size_t>(y) * words_per_row;
+  for (int i = x / WORD_BITS; i <= (x + w - 1) / WORD_BITS; i++) {
+    const U64 mask = get_span_mask(x, w, i);
+    if ((row_words[i] & mask) != mask) {
+      throw std::logic_error("Underflow.");
+    }
+  }
+  std::vector<U8> &counts = row_counts[y];
+  if (counts.empty()) {
+    for (int i = x / WORD_BITS; i <= (x + w - 1) / WORD_BITS; i++) {
+      row_words[i] &= ~get_span_mask(x, w, i);
+    }
+    return;
+  }
+  for (int column = x; column < x + w; column++) {
+    const U8 count = --counts[column];
+    if (count == 1) {
+      row_overlaps[y]--;
+    } else if (count == 0) {
+      row_words[column / WORD_BITS] &= ~(static_cast<U64>(1) << (column % WORD_BITS));
+    }
+  }
+  /* Without overlaps the bits are enough again. Clearing keeps the capacity for the next overlap. */
+  if (row_overlaps[y] == 0) {
+    counts.clear();
+  }
+}
+
+void RigidMatrix::modify(int x, int y, int w, int h, const S8 delta) {
+  if (delta == 0 || !clip(x, y, w, h)) {
+    return;
+  }
+  for (int row = y; row < y + h; row++) {
+    for (int i = 0; i < std::abs(delta); i++) {
+      if (delta > 0) {
+        increment_row(x, row, w);
+      } else {
+        decrement_row(x, row, w);
+      }
+    }
+  }
+}
+
+bool RigidMatrix::is_free(int x, int y, int w, int h) const {
+  if (!clip(x, y, w, h)) {
+    return true;
+  }
+  const int first = x / WORD_BITS;
+  const int last = (x + w - 1) / WORD_BITS;
+  const U64 first_mask = get_word_mask(x - first * WORD_BITS, std::min(x + w - first * WORD_BITS, WORD_BITS));
+  const U64 last_mask = get_word_mask(0, x + w - last * WORD_BITS);
+  for (int row = y; row < y + h; row++) {
+    const U64 *row_words = words.data() + static_cast<size_t>(row) * words_per_row;
+    if (first == last) {
+      if ((row_words[first] & first_mask) != 0) {
+        return false;
+      }
+      continue;
+    }
+    if ((row_words[first] & first_mask) != 0 || (row_words[last] & last_mask) != 0) {
+      return false;
+    }
+    for (int i = first + 1; i < last; i++) {
+      if (row_words[i] != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int RigidMatrix::count_free_columns(const int x, const int y, const int h, const int direction, const int limit) const {
+  if (limit <= 0) {
+    return 0;
+  }
+  /* Rows outside of the box are free, so only the ones inside of it are tested. */
+  const int first_row = std::max(y, box.min_y) - box.min_y;
+  const int last_row = std::min(y + h - 1, box.max_y) - box.min_y;
+  if (first_row > last_row) {
+    return limit;
+  }
+  int count = 0;
+  int column = x;
+  while (count < limit) {
+    if (column < box.min_x || column > box.max_x) {
+      /* Leaving the box, everything beyond it is free. */
+      if ((direction > 0 && column > box.max_x) || (direction < 0 && column < box.min_x)) {
+        return limit;
+      }
+      /* Entering the box, skip to its border. */
+      const int border = direction > 0 ? box.min_x : box.max_x;
+      count += std::abs(border - column);
+      column = border;
+      continue;
+    }
+    const int local = column - box.min_x;
+    const int word_index = local / WORD_BITS;
+    const int bit = local % WORD_BITS;
+    U64 occupied = 0;
+    for (int row = first_row; row <= last_row; row++) {
+      occupied |= words[static_cast<size_t>(row) * words_per_row + word_index];
+    }
+    /* The bits of the columns from the current one to the end of the word, in the direction of the count. */
+    const U64 ahead = direction > 0 ? get_word_mask(bit, WORD_BITS) : get_word_mask(0, bit + 1);
+    occupied &= ahead;
+    if (occupied != 0) {
+      int blocker = bit;
+      while ((occupied >> blocker & 1u) == 0) {
+        blocker += direction;
+      }
+      count += std::abs(blocker - bit);
+      return std::min(count, limit);
+    }
+    const int advance = direction > 0 ? WORD_BITS - bit : bit + 1;
+    count += advance;
+    column += direction * advance;
+  }
+  return limit;
+}
+
+int RigidMatrix::count_free_rows(const int x, const int y, const int w, const int direction, const int limit) const {
+  int count = 0;
+  while (count < limit) {
+    const int row = y + direction * count;
+    /* Once past the box, every row is free. */
+    if ((direction > 0 && row > box.max_y) || (direction < 0 && row < box.min_y)) {
+      return limit;
+    }
+    if (!is_free(x, row, w, 1)) {
+      return count;
+    }
+    count++;
+  }
+  return limit;
+}
+
+int RigidMatrix::sweep(const int x, const int y, const int w, const int h, const int dx, const int dy, const int limit) const {
+  if (limit <= 0) {
+    return 0;
+  }
+  /* The cells which the rectangle still covers after the first step. */
+  if (dx > 0 && is_free(x + 1, y, w - 1, h)) {
+    return count_free_columns(x + w, y, h, 1, limit);
+  }
+  if (dx < 0 && is_free(x, y, w - 1, h)) {
+    return count_free_columns(x - 1, y, h, -1, limit);
+  }
+  if (dy > 0 && is_free(x, y + 1, w, h - 1)) {
+    return count_free_rows(x, y + h, w, 1, limit);
+  }
+  if (dy < 0 && is_free(x, y, w, h - 1)) {
+    return count_free_rows(x, y - 1, w, -1, limit);
+  }
+  return 0;
+}
+
+size_t RigidMatrix::get_memory_usage() const {
+  size_t usage = sizeof(RigidMatrix);
+  usage += words.capacity() * sizeof(U64);
+  usage += row_overlaps.capacity() * sizeof(U32);
+  usage += row_counts.capacity() * sizeof(std::vector<U8>);
+  for (const auto &counts : row_counts) {
+    usage += counts.capacity();
+  }
+  return usage;
+}
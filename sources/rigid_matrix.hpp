@@ -0,0 +1,85 @@
+#ifndef RIGID_MATRIX_H
+#define RIGID_MATRIX_H
+
+#include "box.hpp"
+#include "integers.hpp"
+#include <vector>
+
+/**
+ * Occupancy of the rigid bodies of a BoundingBox, stored as row-major bitsets.
+ *
+ * Each cell has a bit which is set while at least one rigid body covers it. Rows in which bodies overlap also keep a
+ * count for each of their cells, so that removing one of the overlapping bodies does not free the cell.
+ *
+ * Points outside of the box are always free.
+ */
+class RigidMatrix {
+public:
+  RigidMatrix() = default;
+
+  explicit RigidMatrix(BoundingBox box);
+
+  /**
+   * Returns how many rigid bodies cover the provided point.
+   */
+  U8 get(int x, int y) const;
+
+  /**
+   * Adds delta to the count of every cell of the rectangle which lies inside the box.
+   *
+   * Throws a std::logic_error if a count would underflow or overflow.
+   */
+  void modify(int x, int y, int w, int h, S8 delta);
+
+  /**
+   * Evaluates whether or not all the cells of the rectangle are free.
+   *
+   * This tests whole words at a time, so it is much cheaper than testing each cell with get().
+   */
+  bool is_free(int x, int y, int w, int h) const;
+
+  /**
+   * Counts how many consecutive columns, starting at x and going in the provided direction, are free on [y, y + h).
+   *
+   * Stops counting at limit, so the result is in [0, limit].
+   */
+  int count_free_columns(int x, int y, int h, int direction, int limit) const;
+
+  /**
+   * Counts how many consecutive rows, starting at y and going in the provided direction, are free on [x, x + w).
+   *
+   * Stops counting at limit, so the result is in [0, limit].
+   */
+  int count_free_rows(int x, int y, int w, int direction, int limit) const;
+
+  /**
+   * Returns how many one-cell steps along a single axis the rectangle can take before overlapping an occupied cell.
+   *
+   * Exactly one of dx and dy should be nonzero, and only its sign is used. Stops counting at limit.
+   *
+   * This gives the same result as testing the whole rectangle at each step, but only tests the cells it sweeps over.
+   */
+  int sweep(int x, int y, int w, int h, int dx, int dy, int limit) const;
+
+  /**
+   * Returns an approximation of the number of bytes used by this matrix.
+   */
+  size_t get_memory_usage() const;
+
+private:
+  BoundingBox box;
+  size_t columns = 0;
+  size_t words_per_row = 0;
+  std::vector<U64> words;
+  // How many cells of each row are covered by two or more rigid bodies.
+  std::vector<U32> row_overlaps;
+  // The count of each cell of the rows with overlaps. Empty for the other rows, whose counts are their bits.
+  std::vector<std::vector<U8>> row_counts;
+
+  bool clip(int &x, int &y, int &w, int &h) const;
+  U64 get_span_mask(int x, int w, int i) const;
+  void increment_row(int x, int y, int w);
+  void decrement_row(int x, int y, int w);
+};
+
+#endif
@@ -129,77 +129,109 @@ static void log_unused_key(const char *key) {
 
 Settings::Settings(const std::string &filename) {
   char input[SETTINGS_BUFFER_SIZE];
+  read_characters(filename.c_str(), input, SETTINGS_BUFFER_SIZE);
+  load(input);
+}
+
+void Settings::load(const char *input) {
   char key[SETTINGS_STRING_SIZE];
   char value[SETTINGS_STRING_SIZE];
   const char *read = input;
-  read_characters(filename.c_str(), input, SETTINGS_BUFFER_SIZE);
   while (static_cast<int>(parse_line(&read, key, value)) != 0) {
-    if (string_equals(key, "REPOSITION_ALGORITHM")) {
-      if (string_equals(value, "REPOSITION_SELECT_BLINDLY")) {
-        reposition_algorithm = REPOSITION_SELECT_BLINDLY;
-        log_message("Set the reposition algorithm to SELECT_BLINDLY.");
-      } else if (string_equals(value, "REPOSITION_SELECT_AWARELY")) {
-        reposition_algorithm = REPOSITION_SELECT_AWARELY;
-        log_message("Set the reposition algorithm to SELECT_AWARELY.");
-      }
-      /* Did not match any existing algorithm, do not change the default. */
-    } else if (string_equals(key, "PLATFORM_COUNT")) {
-      platform_count = parse<decltype(platform_count)>(value, MINIMUM_PLATFORM_COUNT, MAXIMUM_PLATFORM_COUNT);
-    } else if (string_equals(key, "FONT_SIZE")) {
-      font_size = parse(value, MINIMUM_FONT_SIZE, MAXIMUM_FONT_SIZE);
-    } else if (string_equals(key, "TILES_ON_X")) {
-      tiles_on_x = parse<decltype(tiles_on_x)>(value);
-    } else if (string_equals(key, "TILES_ON_Y")) {
-      tiles_on_y = parse<decltype(tiles_on_y)>(value);
-    } else if (string_equals(key, "BAR_HEIGHT")) {
-      bar_height = parse<decltype(bar_height)>(value);
-    } else if (string_equals(key, "COLOR_PAIR_DEFAULT")) {
-      COLOR_PAIR_DEFAULT = color_pair_from_string(value);
-    } else if (string_equals(key, "COLOR_PAIR_PERK")) {
-      COLOR_PAIR_PERK = color_pair_from_string(value);
-    } else if (string_equals(key, "COLOR_PAIR_PLAYER")) {
-      COLOR_PAIR_PLAYER = color_pair_from_string(value);
-    } else if (string_equals(key, "COLOR_PAIR_TOP_BAR")) {
-      COLOR_PAIR_TOP_BAR = color_pair_from_string(value);
-    } else if (string_equals(key, "COLOR_PAIR_BOTTOM_BAR")) {
-      COLOR_PAIR_BOTTOM_BAR = color_pair_from_string(value);
-    } else if (string_equals(key, "COLOR_PAIR_PLATFORM_A")) {
-      COLOR_PAIR_PLATFORM_A = color_pair_from_string(value);
-    } else if (string_equals(key, "COLOR_PAIR_PLATFORM_B")) {
-      COLOR_PAIR_PLATFORM_B = color_pair_from_string(value);
-    } else if (string_equals(key, "PLAYER_STOPS_PLATFORMS")) {
-      player_stops_platforms = parse_boolean(value);
-    } else if (string_equals(key, "LOGGING_PLAYER_SCORE")) {
-      logging_player_score = parse_boolean(value);
-    } else if (string_equals(key, "JOYSTICK_PROFILE")) {
-      if (string_equals(value, "XBOX")) {
-        joystick_profile = JOYSTICK_PROFILE_XBOX;
-      } else if (string_equals(value, "DUALSHOCK")) {
-        joystick_profile = JOYSTICK_PROFILE_DUALSHOCK;
-      } else {
-        throw std::domain_error("Invalid value for JOYSTICK_PROFILE.");
-      }
-    } else if (string_equals(key, "PLATFORM_MAXIMUM_WIDTH")) {
-      platform_max_width = parse<decltype(platform_max_width)>(value);
-    } else if (string_equals(key, "PLATFORM_MINIMUM_WIDTH")) {
-      platform_min_width = parse<decltype(platform_min_width)>(value);
-    } else if (string_equals(key, "PLATFORM_MAXIMUM_SPEED")) {
-      platform_max_speed = parse<decltype(platform_max_speed)>(value);
-    } else if (string_equals(key, "PLATFORM_MINIMUM_SPEED")) {
-      platform_min_speed = parse<decltype(platform_min_speed)>(value);
-    } else if (string_equals(key, "SCREEN_OCCUPANCY")) {
-      screen_occupancy = parse(value, 0.1f, 1.0f);
-    } else if (string_equals(key, "HIDE_CURSOR")) {
-      hide_cursor = parse_boolean(value);
-    } else if (string_equals(key, "RENDERER_TYPE")) {
-      if (string_equals(value, "HARDWARE")) {
-        renderer_type = RENDERER_HARDWARE;
-      } else {
-        renderer_type = RENDERER_SOFTWARE;
-      }
+    set(key, value);
+  }
+}
+
+void Settings::set(const char *key, const char *value) {
+  text += std::string(key) + " = " + value + "\n";
+  if (string_equals(key, "REPOSITION_ALGORITHM")) {
+    if (string_equals(value, "REPOSITION_SELECT_BLINDLY")) {
+      reposition_algorithm = REPOSITION_SELECT_BLINDLY;
+      log_message("Set the reposition algorithm to SELECT_BLINDLY.");
+    } else if (string_equals(value, "REPOSITION_SELECT_AWARELY")) {
+      reposition_algorithm = REPOSITION_SELECT_AWARELY;
+      log_message("Set the reposition algorithm to SELECT_AWARELY.");
+    }
+    /* Did not match any existing algorithm, do not change the default. */
+  } else if (string_equals(key, "COLLISION_BACKEND")) {
+    if (string_equals(value, "RIGID_MATRIX")) {
+      collision_backend = COLLISION_BACKEND_RIGID_MATRIX;
+      log_message("Set the collision backend to RIGID_MATRIX.");
+    } else if (string_equals(value, "LINE_INDEX")) {
+      collision_backend = COLLISION_BACKEND_LINE_INDEX;
+      log_message("Set the collision backend to LINE_INDEX.");
+    }
+    /* Did not match any existing backend, do not change the default. */
+  } else if (string_equals(key, "RANDOM_SEED")) {
+    random_seed = parse<decltype(random_seed)>(value);
+  } else if (string_equals(key, "PLATFORM_COUNT")) {
+    platform_count = parse<decltype(platform_count)>(value, MINIMUM_PLATFORM_COUNT, MAXIMUM_PLATFORM_COUNT);
+  } else if (string_equals(key, "FONT_SIZE")) {
+    font_size = parse(value, MINIMUM_FONT_SIZE, MAXIMUM_FONT_SIZE);
+  } else if (string_equals(key, "TILES_ON_X")) {
+    tiles_on_x = parse<decltype(tiles_on_x)>(value);
+  } else if (string_equals(key, "TILES_ON_Y")) {
+    tiles_on_y = parse<decltype(tiles_on_y)>(value);
+  } else if (string_equals(key, "PLAYFIELD_TILES_ON_X")) {
+    playfield_tiles_on_x = parse<decltype(playfield_tiles_on_x)>(value);
+  } else if (string_equals(key, "PLAYFIELD_TILES_ON_Y")) {
+    playfield_tiles_on_y = parse<decltype(playfield_tiles_on_y)>(value);
+  } else if (string_equals(key, "PLAYFIELD_PIXELS_PER_TILE")) {
+    playfield_pixels_per_tile = parse<decltype(playfield_pixels_per_tile)>(value);
+  } else if (string_equals(key, "BAR_HEIGHT")) {
+    bar_height = parse<decltype(bar_height)>(value);
+  } else if (string_equals(key, "COLOR_PAIR_DEFAULT")) {
+    COLOR_PAIR_DEFAULT = color_pair_from_string(value);
+  } else if (string_equals(key, "COLOR_PAIR_PERK")) {
+    COLOR_PAIR_PERK = color_pair_from_string(value);
+  } else if (string_equals(key, "COLOR_PAIR_PLAYER")) {
+    COLOR_PAIR_PLAYER = color_pair_from_string(value);
+  } else if (string_equals(key, "COLOR_PAIR_TOP_BAR")) {
+    COLOR_PAIR_TOP_BAR = color_pair_from_string(value);
+  } else if (string_equals(key, "COLOR_PAIR_BOTTOM_BAR")) {
+    COLOR_PAIR_BOTTOM_BAR = color_pair_from_string(value);
+  } else if (string_equals(key, "COLOR_PAIR_PLATFORM_A")) {
+    COLOR_PAIR_PLATFORM_A = color_pair_from_string(value);
+  } else if (string_equals(key, "COLOR_PAIR_PLATFORM_B")) {
+    COLOR_PAIR_PLATFORM_B = color_pair_from_string(value);
+  } else if (string_equals(key, "PLAYER_STOPS_PLATFORMS")) {
+    player_stops_platforms = parse_boolean(value);
+  } else if (string_equals(key, "LOGGING_PLAYER_SCORE")) {
+    logging_player_score = parse_boolean(value);
+  } else if (string_equals(key, "RECORDING_REPLAYS")) {
+    recording_replays = parse_boolean(value);
+  } else if (string_equals(key, "INTERPOLATING_POSITIONS")) {
+    interpolating_positions = parse_boolean(value);
+  } else if (string_equals(key, "JOYSTICK_PROFILE")) {
+    if (string_equals(value, "XBOX")) {
+      joystick_profile = JOYSTICK_PROFILE_XBOX;
+    } else if (string_equals(value, "DUALSHOCK")) {
+      joystick_profile = JOYSTICK_PROFILE_DUALSHOCK;
+    } else {
+      throw std::domain_error("Invalid value for JOYSTICK_PROFILE.");
+    }
+  } else if (string_equals(key, "PLATFORM_MAXIMUM_WIDTH")) {
+    platform_max_width = parse<decltype(platform_max_width)>(value);
+  } else if (string_equals(key, "PLATFORM_MINIMUM_WIDTH")) {
+    platform_min_width = parse<decltype(platform_min_width)>(value);
+  } else if (string_equals(key, "PLATFORM_MAXIMUM_SPEED")) {
+    platform_max_speed = parse<decltype(platform_max_speed)>(value);
+  } else if (string_equals(key, "PLATFORM_MINIMUM_SPEED")) {
+    platform_min_speed = parse<decltype(platform_min_speed)>(value);
+  } else if (string_equals(key, "SCREEN_OCCUPANCY")) {
+    screen_occupancy = parse(value, 0.1f, 1.0f);
+  } else if (string_equals(key, "HIDE_CURSOR")) {
+    hide_cursor = parse_boolean(value);
+  } else if (string_equals(key, "RENDERER_TYPE")) {
+    if (string_equals(value, "HARDWARE")) {
+      renderer_type = RENDERER_HARDWARE;
+    } else if (string_equals(value, "RASTERIZER")) {
+      renderer_type = RENDERER_RASTERIZER;
     } else {
-      log_unused_key(key);
+      renderer_type = RENDERER_SOFTWARE;
     }
+  } else {
+    log_unused_key(key);
   }
 }
 
@@ -207,6 +239,8 @@ void Settings::compute_window_size(U32 width, U32 height) {
   if (computed_window_size) {
     throw std::logic_error("Double initialization.");
   }
+  display_width = width;
+  display_height = height;
   tile_w = 0;
   while (tiles_on_x * (tile_w + 1) < get_screen_occupancy() * width) {
     tile_w++;
@@ -2,22 +2,39 @@
 #define SETTINGS_H
 
 #include "integers.hpp"
+#include <algorithm>
 #include <string>
 
-#define MAXIMUM_PLATFORM_COUNT 256
+#define MAXIMUM_PLATFORM_COUNT (1 << 20)
 
 extern const char *const settings_filename;
 
-enum RendererType { RENDERER_HARDWARE, RENDERER_SOFTWARE };
+enum RendererType { RENDERER_HARDWARE, RENDERER_SOFTWARE, RENDERER_RASTERIZER };
 
 enum JoystickProfile { JOYSTICK_PROFILE_XBOX, JOYSTICK_PROFILE_DUALSHOCK };
 
 enum RepositionAlgorithm { REPOSITION_SELECT_BLINDLY, REPOSITION_SELECT_AWARELY };
 
+enum CollisionBackend { COLLISION_BACKEND_RIGID_MATRIX, COLLISION_BACKEND_LINE_INDEX };
+
 class Settings {
 public:
+  Settings() = default;
+
   explicit Settings(const std::string &filename);
 
+  /**
+   * Applies every setting of the provided text, which uses the format of the settings file.
+   */
+  void load(const char *input);
+
+  /**
+   * Returns text which, when loaded, reproduces every setting changed so far.
+   */
+  inline const std::string &get_text() const {
+    return text;
+  }
+
   inline RendererType get_renderer_type() const {
     return renderer_type;
   }
@@ -30,6 +47,21 @@ public:
     return reposition_algorithm;
   }
 
+  inline CollisionBackend get_collision_backend() const {
+    return collision_backend;
+  }
+
+  /**
+   * Returns the seed of the games, or 0 if each game should be seeded from the clock.
+   */
+  inline U64 get_random_seed() const {
+    return random_seed;
+  }
+
+  inline void set_random_seed(U64 seed) {
+    random_seed = seed;
+  }
+
   inline bool get_hide_cursor() const {
     return hide_cursor;
   }
@@ -42,6 +74,17 @@ public:
     return logging_player_score;
   }
 
+  inline bool is_recording_replays() const {
+    return recording_replays;
+  }
+
+  /**
+   * Evaluates whether or not the moving objects are drawn between their positions on the last two ticks.
+   */
+  inline bool is_interpolating_positions() const {
+    return interpolating_positions;
+  }
+
   inline F32 get_screen_occupancy() const {
     return screen_occupancy;
   }
@@ -87,6 +130,30 @@ public:
     return tiles_on_y;
   }
 
+  /**
+   * Returns the width of the playfield, which is the width of the window unless a larger playfield was set.
+   */
+  inline U32 get_playfield_width() const {
+    return get_tile_w() * std::max(playfield_tiles_on_x, tiles_on_x);
+  }
+
+  /**
+   * Returns the height of the playfield, which is the height of the window without its bars unless a larger playfield
+   * was set.
+   */
+  inline U32 get_playfield_height() const {
+    return get_tile_h() * std::max(playfield_tiles_on_y, tiles_on_y);
+  }
+
+  /**
+   * Returns how many pixels on each axis a tile of the playfield is drawn with before it is scaled up to the tile size.
+   *
+   * 0 means that the playfield is drawn at the resolution of the window.
+   */
+  inline U32 get_playfield_pixels_per_tile() const {
+    return playfield_pixels_per_tile;
+  }
+
   inline U32 get_tile_w() const {
     return tile_w;
   }
@@ -115,12 +182,34 @@ public:
     return platform_min_speed;
   }
 
+  /**
+   * Changes the setting with the provided key, as if it were read from the settings file.
+   *
+   * Settings which affect the window size must be changed before the window size is computed.
+   */
+  void set(const char *key, const char *value);
+
   void compute_window_size(U32 width, U32 height);
 
+  /**
+   * Returns the width of the display the window size was computed for.
+   */
+  inline U32 get_display_width() const {
+    return display_width;
+  }
+
+  inline U32 get_display_height() const {
+    return display_height;
+  }
+
   void validate_settings() const;
 
 private:
+  std::string text;
+
   bool computed_window_size = false;
+  U32 display_width = 0;
+  U32 display_height = 0;
 
   RendererType renderer_type = RENDERER_HARDWARE;
 
@@ -128,9 +217,15 @@ private:
 
   RepositionAlgorithm reposition_algorithm = REPOSITION_SELECT_AWARELY;
 
+  CollisionBackend collision_backend = COLLISION_BACKEND_RIGID_MATRIX;
+
+  U64 random_seed = 0;
+
   bool hide_cursor = true;
   bool player_stops_platforms = false;
   bool logging_player_score = false;
+  bool recording_replays = false;
+  bool interpolating_positions = false;
 
   F32 screen_occupancy = 0.8;
 
@@ -147,6 +242,12 @@ private:
   U32 tiles_on_x = 0;
   U32 tiles_on_y = 0;
 
+  // The playfield is never smaller than the window, so 0 means the size of the window.
+  U32 playfield_tiles_on_x = 0;
+  U32 playfield_tiles_on_y = 0;
+
+  U32 playfield_pixels_per_tile = 0;
+
   U32 tile_w = 0;
   U32 tile_h = 0;
 
@@ -0,0 +1,165 @@
+#include "simulation.hpp"
+#include "physics.hpp"
+#include "text.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * How many ticks the random input holds each direction before choosing again.
+ */
+static const U64 random_hold_ticks = 10;
+
+/**
+ * The random input jumps on one out of this many ticks.
+ */
+static const U32 random_jump_period = 8;
+
+static const int revived_lives = 3;
+
+static Command command_from_name(const std::string &name) {
+  const char *names[COMMAND_COUNT] = {"NONE",    "UP",    "LEFT",  "CENTER", "RIGHT", "DOWN", "JUMP",
+                                      "ENTER",   "CONVERT", "PAUSE", "DEBUG", "QUIT",  "CLOSE"};
+  for (int i = 0; i < COMMAND_COUNT; i++) {
+    if (string_equals(name.c_str(), names[i])) {
+      return static_cast<Command>(i);
+    }
+  }
+  throw std::runtime_error("Unknown command " + name + ".");
+}
+
+SimulationInput::SimulationInput(InputMode mode, U32 seed) : mode(mode), generator(seed) {
+}
+
+SimulationInput::SimulationInput(const std::string &filename) : mode(INPUT_MODE_SCRIPTED) {
+  std::ifstream lines(filename);
+  if (!lines) {
+    throw std::runtime_error("Could not read " + filename + ".");
+  }
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream words(line);
+    Step step{};
+    if (!(words >> step.ticks) || step.ticks == 0) {
+      throw std::runtime_error("Invalid line in " + filename + ": " + line + ".");
+    }
+    std::string name;
+    while (words >> name) {
+      step.commands.push_back(command_from_name(name));
+    }
+    script_length += step.ticks;
+    steps.push_back(step);
+  }
+  if (steps.empty()) {
+    throw std::runtime_error(filename + " has no steps.");
+  }
+}
+
+void SimulationInput::apply(const U64 tick, CommandTable *table) {
+  for (double &status : table->status) {
+    status = 0.0;
+  }
+  if (mode == INPUT_MODE_RANDOM) {
+    if (tick % random_hold_ticks == 0) {
+      const Command directions[3] = {COMMAND_NONE, COMMAND_LEFT, COMMAND_RIGHT};
+      held = directions[generator() % 3];
+    }
+    if (held != COMMAND_NONE) {
+      table->status[held] = 1.0;
+    }
+    if (generator() % random_jump_period == 0) {
+      table->status[COMMAND_JUMP] = 1.0;
+    }
+  } else if (mode == INPUT_MODE_SCRIPTED) {
+    U64 offset = tick % script_length;
+    for (const Step &step : steps) {
+      if (offset < step.ticks) {
+        for (const Command command : step.commands) {
+          table->status[command] = 1.0;
+        }
+        break;
+      }
+      offset -= step.ticks;
+    }
+  }
+}
+
+U64 SimulationInput::count_idle_ticks(const U64 tick) const {
+  if (mode == INPUT_MODE_IDLE) {
+    return std::numeric_limits<U64>::max();
+  }
+  if (mode == INPUT_MODE_RANDOM) {
+    return 0;
+  }
+  U64 offset = tick % script_length;
+  size_t step = 0;
+  while (offset >= steps[step].ticks) {
+    offset -= steps[step].ticks;
+    step++;
+  }
+  U64 idle = 0;
+  /* Count the rest of the current step and the steps after it until one holds a command. */
+  while (steps[step].commands.empty()) {
+    idle += steps[step].ticks - offset;
+    offset = 0;
+    step = (step + 1) % steps.size();
+    if (idle >= script_length) {
+      return std::numeric_limits<U64>::max();
+    }
+  }
+  return idle;
+}
+
+double SimulationResult::get_ticks_per_second() const {
+  if (seconds <= 0.0) {
+    return 0.0;
+  }
+  return ticks / seconds;
+}
+
+SimulationResult run_simulation(Game *const game, SimulationInput &input, const U64 ticks, const bool revive, ReplayRecorder *recorder,
+                                const bool fast_forward) {
+  SimulationResult result;
+  Player *player = game->player;
+  const auto start = std::chrono::steady_clock::now();
+  while (result.ticks < ticks) {
+    if (fast_forward && recorder == nullptr) {
+      const U64 skipped = ::fast_forward(game, std::min(ticks - result.ticks, input.count_idle_ticks(game->current_frame)));
+      game->desired_frame = game->current_frame;
+      result.ticks += skipped;
+      if (skipped != 0) {
+        continue;
+      }
+    }
+    input.apply(game->current_frame, player->table);
+    if (recorder != nullptr) {
+      recorder->record_commands(*game);
+    }
+    update_game(game);
+    update_player(game, player);
+    game->current_frame++;
+    game->desired_frame = game->current_frame;
+    if (recorder != nullptr) {
+      recorder->record_hash(*game);
+    }
+    result.ticks++;
+    if (player->lives == 0) {
+      if (!revive) {
+        break;
+      }
+      player->lives = revived_lives;
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  result.played_frames = game->played_frames;
+  result.score = player->score;
+  result.lives = player->lives;
+  return result;
+}
@@ -0,0 +1,83 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "command.hpp"
+#include "game.hpp"
+#include "replay.hpp"
+#include "integers.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+enum InputMode { INPUT_MODE_IDLE, INPUT_MODE_RANDOM, INPUT_MODE_SCRIPTED };
+
+/**
+ * Provides the commands of a simulated player, one tick at a time.
+ *
+ * A script is a text file in which each line has a number of ticks followed by the names of the commands held during
+ * them, such as "25 RIGHT JUMP". Lines starting with '#' are ignored and the script repeats after its last line.
+ */
+class SimulationInput {
+public:
+  SimulationInput() = default;
+
+  SimulationInput(InputMode mode, U32 seed);
+
+  /**
+   * Loads a script from the provided file. Throws a std::runtime_error if it cannot be read or parsed.
+   */
+  explicit SimulationInput(const std::string &filename);
+
+  inline InputMode get_mode() const {
+    return mode;
+  }
+
+  /**
+   * Writes to the table the commands held on the provided tick.
+   */
+  void apply(U64 tick, CommandTable *table);
+
+  /**
+   * Returns how many ticks, starting at the provided one, are certain to have no command held.
+   *
+   * Random input can hold a command on any tick, so it never has idle ticks.
+   */
+  U64 count_idle_ticks(U64 tick) const;
+
+private:
+  struct Step {
+    U64 ticks;
+    std::vector<Command> commands;
+  };
+
+  InputMode mode = INPUT_MODE_IDLE;
+  std::minstd_rand generator;
+  Command held = COMMAND_NONE;
+  std::vector<Step> steps;
+  U64 script_length = 0;
+};
+
+class SimulationResult {
+public:
+  U64 ticks = 0;
+  U64 played_frames = 0;
+  Score score = 0;
+  int lives = 0;
+  double seconds = 0.0;
+
+  double get_ticks_per_second() const;
+};
+
+/**
+ * Runs up to the provided number of ticks of the game without rendering or pacing.
+ *
+ * The simulation ends early when the player runs out of lives, unless revive is true, in which case the lives are given
+ * back and the simulation continues.
+ *
+ * If a recorder is provided, every tick is recorded into it. Otherwise, if fast_forward is true, runs of idle ticks on
+ * which only the platforms move are skipped at once.
+ */
+SimulationResult run_simulation(Game *game, SimulationInput &input, U64 ticks, bool revive, ReplayRecorder *recorder = nullptr,
+                                bool fast_forward = false);
+
+#endif
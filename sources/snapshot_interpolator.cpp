@@ -0,0 +1,70 @@
+#include "snapshot_interpolator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+/**
+ * Returns the coordinate a fraction of the way from one position to another, or the second position if the distance
+ * is larger than the limit.
+ */
+static int interpolate_coordinate(const int from, const int to, const double fraction, const S64 limit) {
+  if (std::abs(static_cast<S64>(to) - from) > limit) {
+    return to;
+  }
+  return from + static_cast<int>(std::lround((to - from) * fraction));
+}
+
+static Point interpolate_point(const Point &from, const Point &to, const double fraction, const S64 limit_x, const S64 limit_y) {
+  return Point(interpolate_coordinate(from.x, to.x, fraction, limit_x), interpolate_coordinate(from.y, to.y, fraction, limit_y));
+}
+
+void SnapshotInterpolator::push(const RenderSnapshot &snapshot) {
+  for (const U32 index : previous.platform_indices) {
+    previous_positions[index] = 0;
+  }
+  std::swap(previous, current);
+  /* Copying over the oldest snapshot reuses its memory. */
+  current = snapshot;
+  drawn = snapshot;
+  has_previous = has_current && previous.frame < current.frame;
+  has_current = true;
+  for (size_t i = 0; i < previous.platform_indices.size(); i++) {
+    const U32 index = previous.platform_indices[i];
+    if (index >= previous_positions.size()) {
+      previous_positions.resize(index + 1);
+    }
+    previous_positions[index] = i + 1;
+  }
+  if (has_previous) {
+    /* The trail is a list of past positions, so it lags behind the player as well. */
+    drawn.trail = previous.trail;
+  }
+  settled = !has_previous;
+}
+
+const RenderSnapshot &SnapshotInterpolator::interpolate(const Milliseconds now, const int tile_w, const int tile_h) {
+  if (!has_previous) {
+    return drawn;
+  }
+  const double span = static_cast<double>(current.time) - static_cast<double>(previous.time);
+  const double elapsed = static_cast<double>(now) - static_cast<double>(current.time);
+  const double fraction = span > 0.0 ? std::max(0.0, std::min(1.0, elapsed / span)) : 1.0;
+  const auto ticks = static_cast<S64>(current.frame - previous.frame);
+  const S64 limit_x = ticks * tile_w;
+  const S64 limit_y = ticks * tile_h;
+  drawn.origin = interpolate_point(previous.origin, current.origin, fraction, limit_x, limit_y);
+  drawn.player = interpolate_point(previous.player, current.player, fraction, limit_x, limit_y);
+  for (size_t i = 0; i < current.platforms.size(); i++) {
+    const U32 index = current.platform_indices[i];
+    Platform &platform = drawn.platforms[i];
+    platform = current.platforms[i];
+    if (index < previous_positions.size() && previous_positions[index] != 0) {
+      const Platform &before = previous.platforms[previous_positions[index] - 1];
+      platform.x = interpolate_coordinate(before.x, platform.x, fraction, limit_x);
+      platform.y = interpolate_coordinate(before.y, platform.y, fraction, limit_y);
+    }
+  }
+  settled = fraction == 1.0;
+  return drawn;
+}
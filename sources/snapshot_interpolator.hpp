@@ -0,0 +1,50 @@
+#ifndef SNAPSHOT_INTERPOLATOR_H
+#define SNAPSHOT_INTERPOLATOR_H
+
+#include "clock.hpp"
+#include "integers.hpp"
+#include "render_snapshot.hpp"
+#include <vector>
+
+/**
+ * Keeps the last two snapshots of a game and places the moving objects between them, so that frames drawn between two
+ * ticks show motion instead of the same positions again.
+ *
+ * A snapshot is shown as it was after the time between the last two ticks passed since the last one, so the game is
+ * drawn one tick late. Platforms are matched by their index in the platform store. Anything which moved further than
+ * a tile per tick, such as a repositioned platform, is not interpolated.
+ */
+class SnapshotInterpolator {
+public:
+  /**
+   * Makes the snapshot the latest one, and the latest one the one before it.
+   */
+  void push(const RenderSnapshot &snapshot);
+
+  /**
+   * Returns the latest snapshot with its moving objects placed where they are at the provided time.
+   *
+   * Must only be called after a snapshot was pushed.
+   */
+  const RenderSnapshot &interpolate(Milliseconds now, int tile_w, int tile_h);
+
+  /**
+   * Evaluates whether or not the last call to interpolate placed everything at the positions of the latest snapshot,
+   * in which case interpolating again before the next push gives the same snapshot.
+   */
+  inline bool is_settled() const {
+    return settled;
+  }
+
+private:
+  RenderSnapshot previous;
+  RenderSnapshot current;
+  RenderSnapshot drawn;
+  // The position of each platform in the platforms of the previous snapshot, plus one, by platform index.
+  std::vector<size_t> previous_positions;
+  bool has_current = false;
+  bool has_previous = false;
+  bool settled = false;
+};
+
+#endif
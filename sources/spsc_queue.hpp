@@ -0,0 +1,58 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * A bounded queue from one producer thread to one consumer thread, which needs no locks.
+ *
+ * Each index is only written by one of the threads, so pushing and popping are a load and a store each.
+ */
+template <typename T> class SpscQueue {
+public:
+  /**
+   * Creates a queue which holds up to capacity items. Throws a std::logic_error if capacity is not a power of two.
+   */
+  explicit SpscQueue(size_t capacity) : items(capacity), mask(capacity - 1) {
+    if (capacity == 0 || (capacity & mask) != 0) {
+      throw std::logic_error("Capacity is not a power of two.");
+    }
+  }
+
+  /**
+   * Adds an item to the queue. Returns false if the queue is full. Only the producer may call this.
+   */
+  bool push(const T &item) {
+    const size_t tail = next_push.load(std::memory_order_relaxed);
+    if (tail - next_pop.load(std::memory_order_acquire) == items.size()) {
+      return false;
+    }
+    items[tail & mask] = item;
+    next_push.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Removes the oldest item of the queue. Returns false if the queue is empty. Only the consumer may call this.
+   */
+  bool pop(T &item) {
+    const size_t head = next_pop.load(std::memory_order_relaxed);
+    if (head == next_push.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = items[head & mask];
+    next_pop.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T> items;
+  size_t mask;
+  std::atomic<size_t> next_push{0};
+  std::atomic<size_t> next_pop{0};
+};
+
+#endif
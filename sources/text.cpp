@@ -4,6 +4,7 @@
 #include <cstring>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 std::string double_to_string(double value, int places) {
   std::stringstream stream;
@@ -79,6 +80,15 @@ bool string_equals(const char *a, const char *b) {
   return strcmp(a, b) == 0;
 }
 
+unsigned long long string_to_unsigned(const char *string) {
+  char *end = nullptr;
+  const auto value = std::strtoull(string, &end, 10);
+  if (end == string || *end != '\0' || *string == '-') {
+    throw std::invalid_argument(std::string("Expected a number but got ") + string + ".");
+  }
+  return value;
+}
+
 /**
  * Trims a string by removing all leading and trailing spaces.
  */
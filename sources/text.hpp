@@ -27,6 +27,11 @@ size_t copy_string_up_to(char *destination, const char *begin, const char *end,
 
 bool string_equals(const char *a, const char *b);
 
+/**
+ * Parses a nonnegative decimal integer, throwing a std::invalid_argument if the whole string is not one.
+ */
+unsigned long long string_to_unsigned(const char *string);
+
 /**
  * Trims a string by removing whitespace from its start and from its end.
  */
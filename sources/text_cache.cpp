@@ -0,0 +1,70 @@
+#include "text_cache.hpp"
+#include <string>
+
+static std::string get_key(const char *string, const ColorPair color, const int height) {
+  std::string key(string);
+  key.push_back('\0');
+  for (const Color &c : {color.foreground, color.background}) {
+    key.push_back(static_cast<char>(c.r));
+    key.push_back(static_cast<char>(c.g));
+    key.push_back(static_cast<char>(c.b));
+    key.push_back(static_cast<char>(c.a));
+  }
+  key += std::to_string(height);
+  return key;
+}
+
+TextCache::TextCache(const size_t capacity, const GlyphAtlas *atlas) : atlas(atlas), textures(capacity) {
+}
+
+TextCache::~TextCache() {
+  while (textures.size() > 0) {
+    SDL_DestroyTexture(textures.evict().texture);
+  }
+}
+
+TextCache::TextTexture TextCache::acquire_texture(const int w, const int h, SDL_Renderer *renderer) {
+  if (textures.is_full()) {
+    TextTexture evicted = textures.evict();
+    if (evicted.w >= w && evicted.h >= h) {
+      return evicted;
+    }
+    SDL_DestroyTexture(evicted.texture);
+  }
+  TextTexture created;
+  created.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+  created.w = w;
+  created.h = h;
+  return created;
+}
+
+void TextCache::draw(const int x, const int y, const char *string, const ColorPair color, SDL_Renderer *renderer) {
+  const int w = atlas->get_width(string);
+  const int h = atlas->get_height();
+  const std::string key = get_key(string, color, h);
+  TextTexture *cached = textures.find(key);
+  if (cached != nullptr) {
+    hits++;
+  } else {
+    misses++;
+    const TextTexture acquired = acquire_texture(w, h, renderer);
+    if (acquired.texture == nullptr) {
+      atlas->draw(x, y, string, color, renderer);
+      return;
+    }
+    cached = &textures.insert(key, acquired);
+    SDL_Texture *target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, cached->texture);
+    atlas->draw(0, 0, string, color, renderer);
+    SDL_SetRenderTarget(renderer, target);
+  }
+  SDL_Rect source{};
+  source.w = w;
+  source.h = h;
+  SDL_Rect destination{};
+  destination.x = x;
+  destination.y = y;
+  destination.w = w;
+  destination.h = h;
+  SDL_RenderCopy(renderer, cached->texture, &source, &destination);
+}
@@ -0,0 +1,61 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include "color.hpp"
+#include "glyph_atlas.hpp"
+#include "integers.hpp"
+#include "lru_cache.hpp"
+#include <SDL.h>
+
+/**
+ * Textures holding whole strings, drawn once from the glyph atlas and then copied as they are.
+ *
+ * Most of the text on the screen does not change between frames, so drawing it takes one copy instead of one per
+ * character. The textures are keyed by string, color pair and glyph height. When the cache is full, the texture of the
+ * least recently used string is reused if it is large enough, so strings which change every frame do not create
+ * textures once the cache has warmed up.
+ *
+ * Requires a renderer which supports render targets.
+ */
+class TextCache {
+public:
+  TextCache(size_t capacity, const GlyphAtlas *atlas);
+
+  ~TextCache();
+
+  TextCache(const TextCache &) = delete;
+  TextCache &operator=(const TextCache &) = delete;
+
+  /**
+   * Draws a string over its background color, with its top left corner at (x, y), as GlyphAtlas::draw does.
+   */
+  void draw(int x, int y, const char *string, ColorPair color, SDL_Renderer *renderer);
+
+  inline U64 get_hits() const {
+    return hits;
+  }
+
+  inline U64 get_misses() const {
+    return misses;
+  }
+
+private:
+  class TextTexture {
+  public:
+    SDL_Texture *texture = nullptr;
+    int w = 0;
+    int h = 0;
+  };
+
+  /**
+   * Returns a texture of at least the provided size, reusing the least recently used one if the cache is full.
+   */
+  TextTexture acquire_texture(int w, int h, SDL_Renderer *renderer);
+
+  const GlyphAtlas *atlas;
+  LruCache<TextTexture> textures;
+  U64 hits = 0;
+  U64 misses = 0;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include "integers.hpp"
+#include <atomic>
+
+/**
+ * Passes the latest of a series of values from one writer thread to one reader thread without locks.
+ *
+ * The writer fills the back slot and publishes it, which swaps it with the middle slot. The reader swaps the middle slot
+ * with its front slot when it wants the latest value. Neither thread ever waits for the other, and the reader always
+ * sees a whole value. Values which are published while the reader is busy are replaced by newer ones.
+ *
+ * The slots are reused, so a value which holds vectors stops allocating once they have grown enough.
+ */
+template <typename T> class TripleBuffer {
+public:
+  /**
+   * Returns the slot which the writer fills next. It holds the value published two times before, if any.
+   */
+  inline T &get_back() {
+    return slots[back];
+  }
+
+  /**
+   * Makes the back slot the latest value. Only the writer may call this.
+   */
+  inline void publish() {
+    back = middle.exchange(static_cast<U8>(back | fresh), std::memory_order_acq_rel) & index_mask;
+  }
+
+  /**
+   * Moves the latest value to the front slot, if one was published since the last call. Only the reader may call this.
+   *
+   * Returns whether the front slot changed.
+   */
+  inline bool update() {
+    if ((middle.load(std::memory_order_relaxed) & fresh) == 0) {
+      return false;
+    }
+    front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+    return true;
+  }
+
+  /**
+   * Returns the value which the reader got on the last update.
+   */
+  inline const T &get_front() const {
+    return slots[front];
+  }
+
+private:
+  // Set on the middle index when it holds a value which the reader has not taken yet.
+  static const U8 fresh = 4;
+  static const U8 index_mask = 3;
+
+  T slots[3];
+  U8 back = 0;
+  std::atomic<U8> middle{1};
+  U8 front = 2;
+};
+
+#endif
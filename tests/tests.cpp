@@ -3,15 +3,32 @@
 #include "catch/catch.hpp"
 #include "sources/data.hpp"
 #include "sources/io.hpp"
+#include "sources/line_index.hpp"
+#include "sources/line_occupancy.hpp"
 #include "sources/logger.hpp"
+#include "sources/lru_cache.hpp"
+#include "sources/motion.hpp"
 #include "sources/numeric.hpp"
 #include "sources/random.hpp"
+#include "sources/rasterizer.hpp"
+#include "sources/render_list.hpp"
+#include "sources/render_snapshot.hpp"
+#include "sources/replay.hpp"
+#include "sources/rigid_matrix.hpp"
+#include "sources/simulation.hpp"
+#include "sources/snapshot_interpolator.hpp"
 #include "sources/sort.hpp"
+#include "sources/spsc_queue.hpp"
 #include "sources/text.hpp"
+#include "sources/triple_buffer.hpp"
+#include <atomic>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <memory>
+#include <thread>
+#include <utility>
 #include <sources/record_table.hpp>
 
 #define SMALL_STRING_BUFFER_SIZE 64
@@ -49,10 +66,10 @@ TEST_CASE("get_random_perk() is well distributed") {
   int count;
   int i;
 
-  seed_random();
+  RandomGenerator generator(get_time_seed());
 
   for (i = 0; i < test_count; i++) {
-    counters[get_random_perk()]++;
+    counters[get_random_perk(generator)]++;
   }
   /* Assess the distribution of the values. */
   for (i = 0; i < PERK_COUNT; i++) {
@@ -240,7 +257,8 @@ TEST_CASE("generate_platforms() avoids multiple platforms on the same line") {
   box.max_x = platform_count - 1;
   box.max_y = platform_count - 1;
   Settings settings(settings_filename);
-  auto platforms = generate_platforms(settings, box, empty, platform_count, 1, 1);
+  RandomGenerator generator;
+  auto platforms = generate_platforms(settings, box, empty, platform_count, 1, 1, generator);
   /* Each platform in platforms should have a different y coordinate. */
   for (size_t i = 0; i < platform_count; i++) {
     const auto y = platforms[i].y;
@@ -321,8 +339,9 @@ TEST_CASE("random_integer() is evenly distributed") {
 TEST_CASE("select_random_line_blindly() with one empty line") {
   const int tests = 1000;
   const std::vector<U8> array{0};
+  RandomGenerator generator;
   for (int i = 0; i < tests; i++) {
-    REQUIRE(0 == select_random_line_blindly(array));
+    REQUIRE(0 == select_random_line_blindly(array, generator));
   }
 }
 
@@ -331,9 +350,10 @@ TEST_CASE("select_random_line_blindly() with two empty lines") {
   const int tests = 10000;
   const int seven_sixteenths = 7 * tests / 16;
   const std::vector<U8> array{0, 0};
+  RandomGenerator generator;
   int counters[2] = {0, 0};
   for (int i = 0; i < tests; i++) {
-    counters[select_random_line_blindly(array)] += 1;
+    counters[select_random_line_blindly(array, generator)] += 1;
   }
   /* Counters should be roughly the same. */
   REQUIRE(counters[0] > seven_sixteenths);
@@ -344,9 +364,10 @@ TEST_CASE("select_random_line_blindly() with three empty lines") {
   const auto tests = 10000;
   const auto five_sixteenths = 5 * tests / 16;
   const std::vector<U8> array{0, 0, 0};
+  RandomGenerator generator;
   int counters[3] = {0, 0, 0};
   for (int i = 0; i < tests; i++) {
-    counters[select_random_line_blindly(array)] += 1;
+    counters[select_random_line_blindly(array, generator)] += 1;
   }
   /* Counters should be roughly the same. */
   REQUIRE(counters[0] > five_sixteenths);
@@ -357,9 +378,10 @@ TEST_CASE("select_random_line_blindly() with three empty lines") {
 TEST_CASE("select_random_line_blindly() with one occupied line") {
   const auto tests = 10000;
   const std::vector<U8> array{1};
+  RandomGenerator generator;
   for (int i = 0; i < tests; i++) {
     /* There is only one line to select, must select this one. */
-    REQUIRE(0 == select_random_line_blindly(array));
+    REQUIRE(0 == select_random_line_blindly(array, generator));
   }
 }
 
@@ -367,9 +389,10 @@ TEST_CASE("select_random_line_blindly() with occupied middle line") {
   const auto tests = 10000;
   const auto seven_sixteenths = 7 * tests / 16;
   const std::vector<U8> array{0, 1, 0};
+  RandomGenerator generator;
   int counters[3] = {0, 0, 0};
   for (int i = 0; i < tests; i++) {
-    counters[select_random_line_blindly(array)] += 1;
+    counters[select_random_line_blindly(array, generator)] += 1;
   }
   REQUIRE(0 == counters[1]);
   REQUIRE(counters[0] > seven_sixteenths);
@@ -379,9 +402,10 @@ TEST_CASE("select_random_line_blindly() with occupied middle line") {
 TEST_CASE("select_random_line_awarely() with one empty line") {
   const int tests = 1000;
   const std::vector<U8> array{0};
+  RandomGenerator generator;
   for (int i = 0; i < tests; i++) {
     /* There is only one line to select, must select this one. */
-    REQUIRE(0 == select_random_line_awarely(array));
+    REQUIRE(0 == select_random_line_awarely(array, generator));
   }
 }
 
@@ -390,9 +414,10 @@ TEST_CASE("select_random_line_awarely() with two empty lines") {
   const int tests = 10000;
   const int seven_sixteenths = 7 * tests / 16;
   const std::vector<U8> array{0, 0};
+  RandomGenerator generator;
   int counters[2] = {0, 0};
   for (int i = 0; i < tests; i++) {
-    counters[select_random_line_awarely(array)] += 1;
+    counters[select_random_line_awarely(array, generator)] += 1;
   }
   /* Counters should be roughly the same. */
   REQUIRE(counters[0] > seven_sixteenths);
@@ -402,9 +427,10 @@ TEST_CASE("select_random_line_awarely() with two empty lines") {
 TEST_CASE("select_random_line_awarely() with three empty lines") {
   const int tests = 10000;
   const std::vector<U8> array{0, 0, 0};
+  RandomGenerator generator;
   int counters[3] = {0, 0, 0};
   for (int i = 0; i < tests; i++) {
-    counters[select_random_line_awarely(array)] += 1;
+    counters[select_random_line_awarely(array, generator)] += 1;
   }
   /* The middle line is the most distant one. */
   REQUIRE(counters[1] == tests);
@@ -413,9 +439,10 @@ TEST_CASE("select_random_line_awarely() with three empty lines") {
 TEST_CASE("select_random_line_awarely() with one occupied line") {
   const int tests = 1000;
   const std::vector<U8> array{1};
+  RandomGenerator generator;
   for (int i = 0; i < tests; i++) {
     /* There is only one line to select, must select this one. */
-    REQUIRE(0 == select_random_line_awarely(array));
+    REQUIRE(0 == select_random_line_awarely(array, generator));
   }
 }
 
@@ -423,9 +450,10 @@ TEST_CASE("select_random_line_awarely() with occupied middle line") {
   const int tests = 10000;
   const int seven_sixteenths = 7 * tests / 16;
   const std::vector<U8> array{0, 1, 0};
+  RandomGenerator generator;
   int counters[3] = {0, 0, 0};
   for (int i = 0; i < tests; i++) {
-    counters[select_random_line_awarely(array)] += 1;
+    counters[select_random_line_awarely(array, generator)] += 1;
   }
   REQUIRE(0 == counters[1]);
   REQUIRE(counters[0] > seven_sixteenths);
@@ -479,4 +507,656 @@ TEST_CASE("RecordTable maximum size is respected") {
   table.add_record(record_e);
   REQUIRE(table.size() == 2);
   REQUIRE(std::vector<Record>(table.begin(), table.end()) == std::vector<Record>{record_e, record_a});
-}
\ No newline at end of file
+}
+
+TEST_CASE("RigidMatrix spans across word boundaries") {
+  const BoundingBox box{0, 0, 199, 3};
+  RigidMatrix matrix(box);
+  REQUIRE(matrix.is_free(0, 0, 200, 4));
+  matrix.modify(60, 1, 80, 2, 1);
+  REQUIRE(matrix.get(59, 1) == 0);
+  REQUIRE(matrix.get(60, 1) == 1);
+  REQUIRE(matrix.get(139, 2) == 1);
+  REQUIRE(matrix.get(140, 2) == 0);
+  REQUIRE(matrix.is_free(0, 0, 200, 1));
+  REQUIRE(matrix.is_free(0, 1, 60, 2));
+  REQUIRE(matrix.is_free(140, 1, 60, 2));
+  REQUIRE_FALSE(matrix.is_free(0, 1, 61, 1));
+  REQUIRE_FALSE(matrix.is_free(139, 2, 1, 1));
+  REQUIRE_FALSE(matrix.is_free(100, 0, 1, 2));
+  matrix.modify(60, 1, 80, 2, -1);
+  REQUIRE(matrix.is_free(0, 0, 200, 4));
+}
+
+TEST_CASE("RigidMatrix keeps overlapping counts") {
+  const BoundingBox box{0, 0, 99, 0};
+  RigidMatrix matrix(box);
+  matrix.modify(10, 0, 20, 1, 1);
+  matrix.modify(20, 0, 20, 1, 1);
+  REQUIRE(matrix.get(15, 0) == 1);
+  REQUIRE(matrix.get(25, 0) == 2);
+  matrix.modify(10, 0, 20, 1, -1);
+  REQUIRE(matrix.get(15, 0) == 0);
+  REQUIRE(matrix.get(25, 0) == 1);
+  REQUIRE_FALSE(matrix.is_free(20, 0, 20, 1));
+  REQUIRE(matrix.is_free(0, 0, 20, 1));
+  REQUIRE_THROWS_AS(matrix.modify(0, 0, 1, 1, -1), std::logic_error);
+}
+
+TEST_CASE("RigidMatrix treats points outside of the box as free") {
+  const BoundingBox box{10, 10, 19, 19};
+  RigidMatrix matrix(box);
+  matrix.modify(0, 0, 40, 40, 1);
+  REQUIRE(matrix.get(9, 9) == 0);
+  REQUIRE(matrix.get(10, 10) == 1);
+  REQUIRE(matrix.is_free(0, 0, 10, 40));
+  REQUIRE(matrix.is_free(20, 0, 10, 40));
+  REQUIRE_FALSE(matrix.is_free(0, 0, 11, 11));
+}
+
+TEST_CASE("RigidMatrix counts free columns in both directions") {
+  const BoundingBox box{0, 0, 199, 3};
+  RigidMatrix matrix(box);
+  matrix.modify(150, 2, 10, 1, 1);
+  matrix.modify(20, 0, 5, 1, 1);
+  REQUIRE(matrix.count_free_columns(0, 2, 2, 1, 1000) == 150);
+  REQUIRE(matrix.count_free_columns(0, 2, 2, 1, 100) == 100);
+  REQUIRE(matrix.count_free_columns(160, 1, 3, 1, 1000) == 1000);
+  REQUIRE(matrix.count_free_columns(199, 1, 3, -1, 1000) == 40);
+  REQUIRE(matrix.count_free_columns(149, 0, 4, -1, 1000) == 125);
+  REQUIRE(matrix.count_free_columns(-10, 0, 1, 1, 1000) == 30);
+  REQUIRE(matrix.count_free_columns(150, 2, 1, 1, 1000) == 0);
+  REQUIRE(matrix.count_free_columns(0, 4, 2, 1, 7) == 7);
+}
+
+TEST_CASE("RigidMatrix sweep matches testing each step") {
+  const BoundingBox box{0, 0, 99, 99};
+  RigidMatrix matrix(box);
+  matrix.modify(40, 20, 10, 10, 1);
+  matrix.modify(0, 60, 100, 1, 1);
+  const int directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+  for (int x = 0; x < 100; x += 7) {
+    for (int y = 0; y < 100; y += 7) {
+      for (const auto &direction : directions) {
+        int expected = 0;
+        while (expected < 50 && matrix.is_free(x + (expected + 1) * direction[0], y + (expected + 1) * direction[1], 8, 8)) {
+          expected++;
+        }
+        REQUIRE(matrix.sweep(x, y, 8, 8, direction[0], direction[1], 50) == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("LineIndex answers the same queries as RigidMatrix") {
+  const BoundingBox box{0, 0, 149, 99};
+  RigidMatrix matrix(box);
+  LineIndex index(box, 10);
+  std::srand(7);
+  for (int i = 0; i < 40; i++) {
+    const int x = std::rand() % 170 - 10;
+    const int y = std::rand() % 10 * 10;
+    const int w = std::rand() % 40 + 1;
+    matrix.modify(x, y, w, 10, 1);
+    index.modify(x, y, w, 10, 1);
+    if (i % 3 == 0) {
+      matrix.modify(x, y, w, 10, -1);
+      index.modify(x, y, w, 10, -1);
+    }
+  }
+  for (int x = -5; x < 155; x += 3) {
+    for (int y = -5; y < 105; y += 3) {
+      REQUIRE(index.get(x, y) == matrix.get(x, y));
+      REQUIRE(index.is_free(x, y, 7, 12) == matrix.is_free(x, y, 7, 12));
+      REQUIRE(index.count_free_columns(x, y, 12, 1, 60) == matrix.count_free_columns(x, y, 12, 1, 60));
+      REQUIRE(index.count_free_columns(x, y, 12, -1, 60) == matrix.count_free_columns(x, y, 12, -1, 60));
+      REQUIRE(index.count_free_rows(x, y, 7, 1, 60) == matrix.count_free_rows(x, y, 7, 1, 60));
+      REQUIRE(index.count_free_rows(x, y, 7, -1, 60) == matrix.count_free_rows(x, y, 7, -1, 60));
+    }
+  }
+}
+
+TEST_CASE("LineIndex rejects rectangles which are not aligned to lines") {
+  LineIndex index(BoundingBox{0, 0, 99, 99}, 10);
+  REQUIRE_THROWS_AS(index.modify(0, 5, 10, 10, 1), std::logic_error);
+  REQUIRE_THROWS_AS(index.modify(0, 0, 10, 10, -1), std::logic_error);
+}
+
+TEST_CASE("SimulationInput repeats its script") {
+  char filename[] = "test_simulation_script.txt";
+  FILE *file = fopen(filename, "w+");
+  if (file == nullptr) {
+    FAIL("Failed to create helper test file.");
+  }
+  fprintf(file, "# Comment.\n2 RIGHT JUMP\n1\n");
+  fclose(file);
+  SimulationInput input(filename);
+  CommandTable table{};
+  initialize_command_table(&table);
+  const bool expected_right[6] = {true, true, false, true, true, false};
+  for (U64 tick = 0; tick < 6; tick++) {
+    input.apply(tick, &table);
+    REQUIRE((table.status[COMMAND_RIGHT] != 0.0) == expected_right[tick]);
+    REQUIRE(table.status[COMMAND_JUMP] == table.status[COMMAND_RIGHT]);
+    REQUIRE(table.status[COMMAND_LEFT] == 0.0);
+  }
+  remove(filename);
+}
+
+TEST_CASE("RandomGenerator is reproducible and its streams are independent") {
+  RandomGenerator a(42);
+  RandomGenerator b(42);
+  RandomGenerator c(42, 1);
+  int equal_to_other_stream = 0;
+  for (int i = 0; i < 1000; i++) {
+    const U64 value = a.next();
+    REQUIRE(value == b.next());
+    if (value == c.next()) {
+      equal_to_other_stream++;
+    }
+  }
+  REQUIRE(equal_to_other_stream == 0);
+}
+
+TEST_CASE("LineOccupancy selects the same lines as the occupancy vector") {
+  RandomGenerator occupancy_generator(7);
+  for (const U32 line_count : {1u, 5u, 63u, 64u, 65u, 130u}) {
+    for (int round = 0; round < 50; round++) {
+      LineOccupancy occupancy(line_count);
+      std::vector<unsigned char> lines(line_count);
+      const int occupied = occupancy_generator.integer(0, static_cast<int>(line_count));
+      for (int i = 0; i < occupied; i++) {
+        const auto line = static_cast<U32>(occupancy_generator.integer(0, static_cast<int>(line_count - 1)));
+        occupancy.add(line);
+        lines[line] = 1;
+      }
+      RandomGenerator a(round);
+      RandomGenerator b(round);
+      REQUIRE(occupancy.select_blindly(a) == static_cast<U32>(select_random_line_blindly(lines, b)));
+      REQUIRE(occupancy.select_awarely(a) == static_cast<U32>(select_random_line_awarely(lines, b)));
+      REQUIRE(a.next() == b.next());
+    }
+  }
+  LineOccupancy occupancy(3);
+  occupancy.add(1);
+  occupancy.add(1);
+  occupancy.remove(1);
+  REQUIRE(occupancy.get(1) == 1);
+  occupancy.remove(1);
+  REQUIRE_THROWS_AS(occupancy.remove(1), std::logic_error);
+}
+
+TEST_CASE("LineBuckets keeps the platforms of each line") {
+  LineBuckets buckets(2);
+  buckets.add(0, 3);
+  buckets.add(0, 5);
+  buckets.add(1, 4);
+  buckets.remove(0, 3);
+  REQUIRE(buckets.get(0) == std::vector<U32>{5});
+  REQUIRE(buckets.get(1) == std::vector<U32>{4});
+  REQUIRE_THROWS_AS(buckets.remove(1, 5), std::logic_error);
+}
+
+TEST_CASE("string_to_unsigned() only accepts whole nonnegative numbers") {
+  REQUIRE(string_to_unsigned("0") == 0);
+  REQUIRE(string_to_unsigned("18446744073709551615") == 18446744073709551615ULL);
+  REQUIRE_THROWS_AS(string_to_unsigned(""), std::invalid_argument);
+  REQUIRE_THROWS_AS(string_to_unsigned("12a"), std::invalid_argument);
+  REQUIRE_THROWS_AS(string_to_unsigned("-1"), std::invalid_argument);
+}
+
+/**
+ * A game with the test settings on a 1280 by 720 display, after applying the provided changes to the settings.
+ */
+class GameFixture {
+public:
+  Settings settings;
+  CommandTable table{};
+  Player player;
+  Profiler profiler;
+  std::unique_ptr<Game> game;
+
+  explicit GameFixture(U64 seed, const std::vector<std::pair<const char *, const char *>> &changes = {})
+      : settings(settings_filename), player("Test", &table), profiler(false) {
+    settings.compute_window_size(1280, 720);
+    for (const auto &change : changes) {
+      settings.set(change.first, change.second);
+    }
+    initialize_command_table(&table);
+    game = std::unique_ptr<Game>(new Game(&player, &settings, &profiler, seed));
+  }
+};
+
+TEST_CASE("Replay playback matches the recorded game until the state changes") {
+  char filename[] = "test_replay.bin";
+  GameFixture fixture(7);
+  Game &game = *fixture.game;
+  SimulationInput input(INPUT_MODE_RANDOM, 7);
+  ReplayRecorder recorder(game);
+  run_simulation(&game, input, 2000, false, &recorder);
+  recorder.get_replay().save(filename);
+  Replay replay = Replay::load(filename);
+  remove(filename);
+  REQUIRE(replay.get_tick_count() > 100);
+  REQUIRE(replay.changes.size() == recorder.get_replay().changes.size());
+  REQUIRE_FALSE(play_replay(replay, false).diverged);
+  const U64 tampered_tick = replay.get_tick_count() / 2;
+  replay.hashes[tampered_tick]++;
+  const PlaybackResult result = play_replay(replay, false);
+  REQUIRE(result.diverged);
+  REQUIRE(result.divergent_tick == tampered_tick);
+}
+
+TEST_CASE("Game restore returns to the snapshot state") {
+  GameFixture fixture(11);
+  Game &game = *fixture.game;
+  SimulationInput warm_up(INPUT_MODE_RANDOM, 11);
+  run_simulation(&game, warm_up, 100, true);
+  const GameSnapshot snapshot = game.snapshot();
+  const U32 snapshot_hash = hash_game_state(game);
+  std::vector<U32> first_run;
+  for (int run = 0; run < 2; run++) {
+    game.restore(snapshot);
+    REQUIRE(hash_game_state(game) == snapshot_hash);
+    SimulationInput input(INPUT_MODE_RANDOM, 12);
+    for (int tick = 0; tick < 200; tick++) {
+      run_simulation(&game, input, 1, true);
+      if (run == 0) {
+        first_run.push_back(hash_game_state(game));
+      } else {
+        REQUIRE(hash_game_state(game) == first_run[tick]);
+      }
+    }
+  }
+  /* The collider must match one built from scratch for the restored platforms. */
+  game.restore(snapshot);
+  Collider expected(fixture.settings.get_collision_backend(), game.box, game.tile_h);
+  for (size_t i = 0; i < game.platforms.size(); i++) {
+    const Platform platform = game.platforms.get(i);
+    expected.modify(platform.x, platform.y, platform.w, platform.h, 1);
+  }
+  for (int y = game.box.min_y; y <= game.box.max_y; y += 3) {
+    for (int x = game.box.min_x; x <= game.box.max_x; x += 3) {
+      REQUIRE(game.collider.get(x, y) == expected.get(x, y));
+    }
+  }
+}
+
+TEST_CASE("Games with more platforms than fit in the window get a larger playfield") {
+  GameFixture fixture(13, {{"PLATFORM_COUNT", "5000"}, {"PLAYFIELD_TILES_ON_Y", "10000"}});
+  Game &game = *fixture.game;
+  REQUIRE(game.platforms.size() == 5000);
+  REQUIRE(game.box.max_x == static_cast<int>(fixture.settings.get_window_width()));
+  REQUIRE(game.box.max_y == static_cast<int>(10000 * fixture.settings.get_tile_h()));
+  SimulationInput input(INPUT_MODE_RANDOM, 13);
+  run_simulation(&game, input, 50, true);
+  for (size_t i = 0; i < game.platforms.size(); i++) {
+    REQUIRE(game.lines.get(static_cast<U32>((game.platforms.y[i] - game.box.min_y) / game.tile_h)) > 0);
+  }
+}
+
+TEST_CASE("Fast-forward leaves the game as running every tick would") {
+  GameFixture exact_fixture(17);
+  GameFixture skipping_fixture(17);
+  Game &exact = *exact_fixture.game;
+  Game &skipping = *skipping_fixture.game;
+  const Player &exact_player = exact_fixture.player;
+  const Player &skipping_player = skipping_fixture.player;
+  /* Play until the player dies, after which it stays inactive, and then leave it idle. */
+  for (Game *game : {&exact, &skipping}) {
+    SimulationInput input(INPUT_MODE_RANDOM, 17);
+    run_simulation(game, input, 600, true);
+  }
+  SimulationInput idle(INPUT_MODE_IDLE, 0);
+  for (int round = 0; round < 20; round++) {
+    run_simulation(&exact, idle, 500, true);
+    const SimulationResult result = run_simulation(&skipping, idle, 500, true, nullptr, true);
+    REQUIRE(result.ticks == 500);
+    REQUIRE(skipping.current_frame == exact.current_frame);
+    REQUIRE(hash_game_state(skipping) == hash_game_state(exact));
+    REQUIRE(std::string(skipping.message) == std::string(exact.message));
+    REQUIRE(skipping_player.graphics.trail.size() == exact_player.graphics.trail.size());
+    REQUIRE(skipping_player.graphics.trail.front().x == exact_player.graphics.trail.front().x);
+    REQUIRE(skipping_player.graphics.trail.front().y == exact_player.graphics.trail.front().y);
+  }
+  REQUIRE_FALSE(exact_player.physics);
+  for (int y = exact.box.min_y; y <= exact.box.max_y; y += 5) {
+    for (int x = exact.box.min_x; x <= exact.box.max_x; x += 5) {
+      REQUIRE(skipping.collider.get(x, y) == exact.collider.get(x, y));
+    }
+  }
+}
+
+TEST_CASE("get_motion() adds up to the exact distance over any run of ticks") {
+  for (const S64 speed : {0, 1, 29, 57, 256, 1920, -1920, -2881}) {
+    for (const U32 period : {50u, 256u}) {
+      S64 total = 0;
+      for (U64 tick = 0; tick < 3 * period; tick++) {
+        const S64 motion = get_motion(tick, 1, speed, period);
+        REQUIRE(std::abs(motion) <= (std::abs(speed) + period - 1) / period);
+        total += motion;
+        REQUIRE(get_motion(0, tick + 1, speed, period) == total);
+        REQUIRE(get_motion(tick + 1000 * period, 1, speed, period) == motion);
+      }
+      REQUIRE(total == 3 * speed);
+    }
+  }
+}
+
+TEST_CASE("TripleBuffer hands the reader the latest published value") {
+  TripleBuffer<int> buffer;
+  REQUIRE_FALSE(buffer.update());
+  buffer.get_back() = 1;
+  buffer.publish();
+  buffer.get_back() = 2;
+  buffer.publish();
+  REQUIRE(buffer.update());
+  REQUIRE(buffer.get_front() == 2);
+  REQUIRE_FALSE(buffer.update());
+  REQUIRE(buffer.get_front() == 2);
+  buffer.get_back() = 3;
+  buffer.publish();
+  REQUIRE(buffer.update());
+  REQUIRE(buffer.get_front() == 3);
+}
+
+TEST_CASE("SpscQueue keeps the order and reports when it is full or empty") {
+  REQUIRE_THROWS_AS(SpscQueue<int>(3), std::logic_error);
+  REQUIRE_THROWS_AS(SpscQueue<int>(0), std::logic_error);
+  SpscQueue<int> queue(4);
+  int item = 0;
+  REQUIRE_FALSE(queue.pop(item));
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 4; i++) {
+      REQUIRE(queue.push(round * 4 + i));
+    }
+    REQUIRE_FALSE(queue.push(-1));
+    for (int i = 0; i < 4; i++) {
+      REQUIRE(queue.pop(item));
+      REQUIRE(item == round * 4 + i);
+    }
+    REQUIRE_FALSE(queue.pop(item));
+  }
+}
+
+TEST_CASE("TripleBuffer and SpscQueue pass values between two threads") {
+  const int count = 100000;
+  TripleBuffer<std::vector<int>> buffer;
+  SpscQueue<int> queue(64);
+  std::thread writer([&buffer, &queue, count]() {
+    for (int i = 1; i <= count; i++) {
+      while (!queue.push(i)) {
+      }
+      buffer.get_back().assign(8, i);
+      buffer.publish();
+    }
+  });
+  int expected = 1;
+  int item = 0;
+  int latest = 0;
+  while (expected <= count) {
+    if (queue.pop(item)) {
+      REQUIRE(item == expected);
+      expected++;
+    }
+    if (buffer.update()) {
+      const std::vector<int> &front = buffer.get_front();
+      REQUIRE(front.size() == 8);
+      REQUIRE(front.front() == front.back());
+      REQUIRE(front.front() > latest);
+      latest = front.front();
+    }
+  }
+  writer.join();
+  buffer.update();
+  REQUIRE(buffer.get_front().front() == count);
+}
+
+TEST_CASE("RenderSnapshot copies the platforms in view") {
+  GameFixture fixture(19);
+  Game &game = *fixture.game;
+  Player &player = fixture.player;
+  RenderSnapshot snapshot;
+  snapshot.capture(game, true);
+  REQUIRE(snapshot.platforms.size() == game.platforms.size());
+  REQUIRE(snapshot.player.x == player.x);
+  REQUIRE(snapshot.collider.size() == static_cast<size_t>(snapshot.view_width) * snapshot.view_height);
+  REQUIRE_FALSE(snapshot.finished);
+  player.lives = 0;
+  snapshot.capture(game, false);
+  REQUIRE(snapshot.finished);
+}
+
+TEST_CASE("LruCache evicts the least recently used entry") {
+  REQUIRE_THROWS_AS(LruCache<int>(0), std::logic_error);
+  LruCache<int> cache(3);
+  REQUIRE_THROWS_AS(cache.evict(), std::logic_error);
+  cache.insert("a", 1);
+  cache.insert("b", 2);
+  cache.insert("c", 3);
+  REQUIRE(cache.is_full());
+  REQUIRE_THROWS_AS(cache.insert("d", 4), std::logic_error);
+  REQUIRE(*cache.find("a") == 1);
+  REQUIRE(cache.find("d") == nullptr);
+  REQUIRE(cache.evict() == 2);
+  cache.insert("d", 4);
+  REQUIRE(cache.evict() == 3);
+  REQUIRE(cache.evict() == 1);
+  REQUIRE(cache.find("a") == nullptr);
+  REQUIRE(*cache.find("d") == 4);
+  REQUIRE(cache.size() == 1);
+}
+
+static std::vector<std::string> drawn_texts;
+
+static void record_drawn_text(int, int, const char *string, ColorPair, SDL_Renderer *) {
+  drawn_texts.emplace_back(string);
+}
+
+TEST_CASE("RenderList draws each layer in one call per state") {
+  const Color a(10, 20, 30, 255);
+  const Color b(40, 50, 60, 255);
+  RenderList list;
+  for (int round = 0; round < 2; round++) {
+    drawn_texts.clear();
+    list.clear();
+    list.add_text(RENDER_LAYER_TRAIL, 0, 0, 3, 1, "top", COLOR_PAIR_DEFAULT);
+    list.add_rectangle(RENDER_LAYER_PLATFORMS, 0, 0, 4, 4, a);
+    list.add_rectangle(RENDER_LAYER_PLATFORMS, 8, 0, 4, 4, b);
+    list.add_rectangle(RENDER_LAYER_PLATFORMS, 16, 0, 4, 4, a);
+    list.add_blended_rectangle(RENDER_LAYER_TRAIL, 0, 8, 4, 4, Color(1, 2, 3, 10));
+    list.add_blended_rectangle(RENDER_LAYER_TRAIL, 1, 8, 4, 4, Color(1, 2, 3, 20));
+    list.add_rectangle(RENDER_LAYER_PLATFORMS, 24, 0, 4, 4, a);
+    list.add_text(RENDER_LAYER_BARS, 0, 0, 6, 1, "bottom", COLOR_PAIR_DEFAULT);
+    const RenderListStatistics statistics = list.submit(nullptr, record_drawn_text);
+    REQUIRE(statistics.rectangles == 6);
+    REQUIRE(statistics.texts == 2);
+    REQUIRE(statistics.draw_calls == 6);
+    REQUIRE(drawn_texts == std::vector<std::string>({"bottom", "top"}));
+  }
+}
+
+static U64 count_covered_points(const std::vector<SDL_Rect> &rectangles, int x, int y) {
+  U64 covered = 0;
+  for (const SDL_Rect &rectangle : rectangles) {
+    if (x >= rectangle.x && x < rectangle.x + rectangle.w && y >= rectangle.y && y < rectangle.y + rectangle.h) {
+      covered++;
+    }
+  }
+  return covered;
+}
+
+TEST_CASE("RenderList finds only the regions which changed between frames") {
+  const Color a(10, 20, 30, 255);
+  const Color b(40, 50, 60, 255);
+  RenderList previous;
+  previous.add_rectangle(RENDER_LAYER_PLATFORMS, 10, 0, 8, 2, a);
+  previous.add_rectangle(RENDER_LAYER_PLATFORMS, 40, 4, 8, 2, b);
+  previous.add_text(RENDER_LAYER_BARS, 0, 10, 4, 2, "text", COLOR_PAIR_DEFAULT);
+  previous.sort();
+  std::vector<SDL_Rect> dirty;
+  previous.find_differences(previous, dirty);
+  REQUIRE(dirty.empty());
+  RenderList current;
+  current.add_rectangle(RENDER_LAYER_PLATFORMS, 13, 0, 8, 2, a);
+  current.add_rectangle(RENDER_LAYER_PLATFORMS, 40, 4, 8, 2, b);
+  current.add_text(RENDER_LAYER_BARS, 0, 10, 4, 2, "next", COLOR_PAIR_DEFAULT);
+  current.sort();
+  current.find_differences(previous, dirty);
+  merge_overlapping_rectangles(dirty);
+  U64 dirty_area = 0;
+  for (const SDL_Rect &rectangle : dirty) {
+    dirty_area += rectangle.w * rectangle.h;
+  }
+  // Two strips of 3 by 2 where the platform moved and the 4 by 2 text.
+  REQUIRE(dirty_area == 3 * 2 + 3 * 2 + 4 * 2);
+  for (int y = 0; y < 16; y++) {
+    for (int x = 0; x < 64; x++) {
+      REQUIRE(count_covered_points(dirty, x, y) <= 1);
+    }
+  }
+  REQUIRE(count_covered_points(dirty, 10, 0) == 1);
+  REQUIRE(count_covered_points(dirty, 20, 1) == 1);
+  REQUIRE(count_covered_points(dirty, 14, 0) == 0);
+  REQUIRE(count_covered_points(dirty, 44, 4) == 0);
+}
+
+TEST_CASE("Rasterizer blends as SDL does and draws the same with any number of bands") {
+  const int w = 37;
+  const int h = 200;
+  const Color background(0, 0, 255, 255);
+  std::vector<std::vector<U32>> frames;
+  for (const unsigned bands : {1u, 3u, 8u}) {
+    Rasterizer rasterizer(w, h, bands, nullptr);
+    std::vector<U32> pixels(w * h);
+    rasterizer.set_target(pixels.data(), w * static_cast<int>(sizeof(U32)));
+    RenderList list;
+    list.add_rectangle(RENDER_LAYER_PLATFORMS, -5, 10, 20, 150, Color(10, 20, 30, 255));
+    list.add_blended_rectangle(RENDER_LAYER_TRAIL, 3, 50, 33, 120, Color(255, 0, 0, 128));
+    list.add_rectangle(RENDER_LAYER_PLAYER, 30, 190, 20, 20, Color(1, 2, 3, 255));
+    list.add_text(RENDER_LAYER_BARS, 0, 0, 4, 2, "text", COLOR_PAIR_DEFAULT);
+    // The threads of the bands are reused from frame to frame.
+    list.submit(rasterizer, Color(9, 9, 9, 255));
+    const RenderListStatistics statistics = list.submit(rasterizer, background);
+    REQUIRE(statistics.rectangles == 3);
+    REQUIRE(statistics.draw_calls == 0);
+    REQUIRE(pixels[0 * w + 20] == 0xFF0000FFu);
+    REQUIRE(pixels[20 * w + 0] == 0xFF0A141Eu);
+    // (255 * 128 + 0 * 127) / 255 and (0 * 128 + 255 * 127) / 255, rounded.
+    REQUIRE(pixels[100 * w + 20] == 0xFF80007Fu);
+    REQUIRE(pixels[100 * w + 35] == 0xFF80007Fu);
+    REQUIRE(pixels[100 * w + 36] == 0xFF0000FFu);
+    REQUIRE(pixels[199 * w + 36] == 0xFF010203u);
+    frames.push_back(pixels);
+  }
+  REQUIRE(frames[0] == frames[1]);
+  REQUIRE(frames[0] == frames[2]);
+}
+
+TEST_CASE("Rasterizer passes on the exceptions of its bands and keeps working") {
+  Rasterizer rasterizer(10, 200, 4, nullptr);
+  REQUIRE(rasterizer.get_band_count() == 4);
+  const auto throw_below_top = [](const SDL_Rect &band) {
+    if (band.y > 0) {
+      throw std::runtime_error("Band failed.");
+    }
+  };
+  REQUIRE_THROWS_AS(rasterizer.for_each_band(throw_below_top), std::runtime_error);
+  std::atomic<int> rows{0};
+  rasterizer.for_each_band([&rows](const SDL_Rect &band) { rows += band.h; });
+  REQUIRE(rows == 200);
+}
+
+TEST_CASE("RenderList scales tiles to the same number of pixels wherever they are") {
+  // A playfield of 4 by 3 tiles of 10 by 20 pixels, 30 pixels below the top bar, drawn with 2 pixels per tile.
+  SDL_Rect source{};
+  source.y = 30;
+  source.w = 40;
+  source.h = 60;
+  const int w = 8;
+  const int h = 6;
+  RenderList list;
+  list.add_rectangle(RENDER_LAYER_PLATFORMS, 3, 30, 20, 20, Color(1, 1, 1, 255));
+  list.add_rectangle(RENDER_LAYER_PLAYER, -4, 70, 10, 20, Color(2, 2, 2, 255));
+  list.add_rectangle(RENDER_LAYER_PERK, 30, 30, 2, 2, Color(3, 3, 3, 255));
+  list.scale_to(source, w, h);
+  Rasterizer rasterizer(w, h, 1, nullptr);
+  std::vector<U32> pixels(w * h);
+  rasterizer.set_target(pixels.data(), w * static_cast<int>(sizeof(U32)));
+  const RenderListStatistics statistics = list.submit(rasterizer, Color(0, 0, 0, 255));
+  // The perk was smaller than a pixel, so it is gone.
+  REQUIRE(statistics.rectangles == 2);
+  const std::vector<U32> expected = {
+      0xFF000000, 0xFF010101, 0xFF010101, 0xFF010101, 0xFF010101, 0xFF000000, 0xFF000000, 0xFF000000,
+      0xFF000000, 0xFF010101, 0xFF010101, 0xFF010101, 0xFF010101, 0xFF000000, 0xFF000000, 0xFF000000,
+      0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000,
+      0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000,
+      0xFF020202, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000,
+      0xFF020202, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000,
+  };
+  REQUIRE(pixels == expected);
+}
+
+static Platform make_platform(const int x, const int y) {
+  Platform platform;
+  platform.x = x;
+  platform.y = y;
+  platform.w = 30;
+  platform.h = 10;
+  return platform;
+}
+
+TEST_CASE("SnapshotInterpolator moves platforms between ticks and leaves repositioned ones alone") {
+  RenderSnapshot before;
+  before.frame = 1;
+  before.time = 1000;
+  before.player = Point(100, 50);
+  before.platforms = {make_platform(0, 0), make_platform(500, 20), make_platform(40, 40)};
+  before.platform_indices = {0, 1, 2};
+  RenderSnapshot after = before;
+  after.frame = 2;
+  after.time = 1020;
+  after.player = Point(104, 50);
+  // Platform 0 moved, platform 1 was repositioned to the other side, platform 2 left the view and 3 entered it.
+  after.platforms = {make_platform(8, 0), make_platform(-30, 20), make_platform(70, 30)};
+  after.platform_indices = {0, 1, 3};
+  SnapshotInterpolator interpolator;
+  interpolator.push(before);
+  REQUIRE(interpolator.interpolate(1010, 10, 10).platforms[0].x == 0);
+  REQUIRE(interpolator.is_settled());
+  interpolator.push(after);
+  REQUIRE_FALSE(interpolator.is_settled());
+  const RenderSnapshot &halfway = interpolator.interpolate(1030, 10, 10);
+  REQUIRE(halfway.player.x == 102);
+  REQUIRE(halfway.platforms[0].x == 4);
+  REQUIRE(halfway.platforms[1].x == -30);
+  REQUIRE(halfway.platforms[2].x == 70);
+  REQUIRE_FALSE(interpolator.is_settled());
+  REQUIRE(interpolator.interpolate(1020, 10, 10).platforms[0].x == 0);
+  const RenderSnapshot &later = interpolator.interpolate(1100, 10, 10);
+  REQUIRE(later.platforms[0].x == 8);
+  REQUIRE(later.player.x == 104);
+  REQUIRE(interpolator.is_settled());
+}
+
+TEST_CASE("RenderSnapshot copies again only the collider rows which changed") {
+  GameFixture fixture(23);
+  Game &game = *fixture.game;
+  SimulationInput input(INPUT_MODE_RANDOM, 23);
+  /* Alternate between slots, as the triple buffer does, so each capture starts from an older copy. */
+  RenderSnapshot slots[2];
+  for (int round = 0; round < 20; round++) {
+    run_simulation(&game, input, 7, true);
+    RenderSnapshot &snapshot = slots[round % 2];
+    snapshot.capture(game, true);
+    size_t i = 0;
+    size_t differences = 0;
+    for (int y = 0; y < snapshot.view_height; y++) {
+      REQUIRE(snapshot.collider_versions[y] == game.collider.get_row_version(snapshot.origin.y + y));
+      for (int x = 0; x < snapshot.view_width; x++) {
+        differences += snapshot.collider[i++] != get_from_rigid_matrix(&game, snapshot.origin.x + x, snapshot.origin.y + y);
+      }
+    }
+    REQUIRE(differences == 0);
+  }
+}